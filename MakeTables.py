@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#Generates MathTables.h for the log, trig and hyperbolic CORDIC tables and the
+#constants used with them so they all have the same number of digits
+#Usage: python3 MakeTables.py [digits] > MathTables.h
+#
+#digits is the number of decimal places the tables are good for (16, 32, 56...)
+#and at most 56 so MultBCD's product of two full numbers fits in a cell
+#Each entry has 2 whole digits so entries are digits+2 long, packed 2 per byte
+#with leading zero bytes dropped. The first byte of each entry is the number of
+#bytes that follow. Each table ends with a 0.
+
+import sys
+from decimal import Decimal, getcontext, ROUND_HALF_UP
+
+#MATH_CELL_SIZE in RPNcalc2.c
+CELL_SIZE=120
+
+def Pi():
+  #Machin: pi/4 = 4*atan(1/5) - atan(1/239)
+  return 4*(4*AtanInv(5)-AtanInv(239))
+
+def AtanInv(n):
+  #atan(1/n) by Taylor series
+  total=Decimal(0)
+  power=Decimal(1)/n
+  n2=n*n
+  k=1
+  sign=1
+  while power:
+    total+=sign*power/k
+    power/=n2
+    k+=2
+    sign=-sign
+  return total
+
+def Atan(x):
+  #only called with x=2^-i, i>0 so series converges quickly
+  total=Decimal(0)
+  power=x
+  x2=x*x
+  k=1
+  sign=1
+  while power:
+    total+=sign*power/k
+    power*=x2
+    k+=2
+    sign=-sign
+  return total
+
+def Atanh(x):
+  return ((1+x)/(1-x)).ln()/2
+
+def Packed(value, digits):
+  #value rounded to digits decimal places, 2 whole digits, BCD packed
+  scaled=(value*(Decimal(10)**digits)).quantize(Decimal(1),rounding=ROUND_HALF_UP)
+  text=str(int(scaled)).rjust(digits+2,'0')
+  if len(text)>digits+2: raise ValueError("entry too large")
+  data=[int(text[i:i+2],16) for i in range(0,len(text),2)]
+  while data and data[0]==0: data.pop(0)
+  return data
+
+def Fixed(value, whole, digits):
+  scaled=(value*(Decimal(10)**digits)).quantize(Decimal(1),rounding=ROUND_HALF_UP)
+  text=str(int(scaled)).rjust(whole+digits,'0')
+  return text[:-digits]+"."+text[-digits:]
+
+def WriteTable(out, name, entries):
+  out.append("static const unsigned char %s[]={" % name)
+  for entry in entries:
+    out.append("  %d ,%s," % (len(entry),",".join("0x%02X" % b for b in entry)))
+  out.append("  0};")
+  out.append("")
+
+def main():
+  digits=int(sys.argv[1]) if len(sys.argv)>1 else 32
+  if (digits<6) or (digits%2):
+    sys.exit("digits must be even and at least 6")
+  #sign, length and decimal places then 2 numbers of digits+1 digits each
+  if 2*(digits+1)+3>CELL_SIZE:
+    sys.exit("digits must be at most %d for %d byte cells" % ((CELL_SIZE-5)//2//2*2,CELL_SIZE))
+
+  getcontext().prec=digits+20
+  pi=Pi()
+  ln2=Decimal(2).ln()
+
+  smallest=Decimal(10)**-digits
+
+  #Log table: ln(2^128) down to ln(2), then ln(1+2^-i) until below last digit
+  logs=[Packed(ln2*(2**(7-i)),digits) for i in range(8)]
+  i=1
+  while True:
+    value=(1+Decimal(2)**-i).ln()
+    if value<smallest: break
+    logs.append(Packed(value,digits))
+    i+=1
+
+  #Trig table: atan(2^-i) in degrees until below last digit
+  trig=[Packed(Decimal(45),digits)]
+  i=1
+  while True:
+    value=Atan(Decimal(2)**-i)*180/pi
+    if value<smallest: break
+    trig.append(Packed(value,digits))
+    i+=1
+
+  #Hyperbolic table: atanh(2^-i) starting from i=1 until below last digit
+  hyper=[]
+  i=1
+  while True:
+    value=Atanh(Decimal(2)**-i)
+    if value<smallest: break
+    hyper.append(Packed(value,digits))
+    i+=1
+
+  #CORDIC gain for as many iterations as there are trig entries
+  gain=Decimal(1)
+  for i in range(len(trig)):
+    gain*=1/(1+Decimal(4)**-i).sqrt()
+
+  #Hyperbolic gain is inverted since CalcTanBCD starts with x=1/gain
+  #4, 13, 40... are done twice so they count twice
+  hyp_gain=Decimal(1)
+  repeat=4
+  for i in range(1,len(hyper)+1):
+    hyp_gain*=(1-Decimal(4)**-i).sqrt()
+    if i==repeat:
+      hyp_gain*=(1-Decimal(4)**-i).sqrt()
+      repeat=3*repeat+1
+
+  entry_size=digits+5
+  out=[]
+  out.append("//Generated by MakeTables.py for %d decimal places. Do not edit." % digits)
+  out.append("//Regenerate with: python3 MakeTables.py %d > MathTables.h" % digits)
+  out.append("")
+  out.append("#define MATH_DIGITS %d" % digits)
+  out.append("#define MATH_ENTRY_SIZE %d" % entry_size)
+  out.append("#define MATH_LOG_TABLE %d" % len(logs))
+  out.append("#define MATH_TRIG_TABLE %d" % len(trig))
+  out.append("#define MATH_HYP_TABLE %d" % len(hyper))
+  #literal sizes since MM_GLOBALS can't multiply
+  out.append("#define MATH_LOG_BYTES %d" % (len(logs)*entry_size))
+  out.append("#define MATH_TRIG_BYTES %d" % (len(trig)*entry_size))
+  out.append("#define MATH_HYP_BYTES %d" % (len(hyper)*entry_size))
+  out.append("")
+  out.append("#define K             \"%s\"" % Fixed(gain,1,digits))
+  out.append("#define K_hyp         \"%s\"" % Fixed(1/hyp_gain,1,digits))
+  out.append("#define log10_factor  \"%s\"" % Fixed(Decimal(10).ln(),1,digits))
+  out.append("#define pi            \"%s\"" % Fixed(pi,1,digits))
+  out.append("#define deg_factor    \"%s\"" % Fixed(180/pi,2,digits))
+  out.append("")
+  WriteTable(out,"LogTable",logs)
+  WriteTable(out,"TrigTable",trig)
+  WriteTable(out,"HypTable",hyper)
+  sys.stdout.write("\n".join(out))
+
+main()
@@ -0,0 +1,377 @@
+//Generated by MakeTables.py for 34 decimal places. Do not edit.
+//Regenerate with: python3 MakeTables.py 34 > MathTables.h
+
+#define MATH_DIGITS 34
+#define MATH_ENTRY_SIZE 39
+#define MATH_LOG_TABLE 120
+#define MATH_TRIG_TABLE 119
+#define MATH_HYP_TABLE 112
+#define MATH_LOG_BYTES 4680
+#define MATH_TRIG_BYTES 4641
+#define MATH_HYP_BYTES 4368
+
+#define K             "0.6072529350088812561694467525049283"
+#define K_hyp         "1.2074970677630721288777210113109158"
+#define log10_factor  "2.3025850929940456840179914546843642"
+#define pi            "3.1415926535897932384626433832795029"
+#define deg_factor    "57.2957795130823208767981548141051703"
+
+static const unsigned char LogTable[]={
+  18 ,0x88,0x72,0x28,0x39,0x11,0x16,0x72,0x99,0x96,0x05,0x40,0x57,0x11,0x54,0x66,0x46,0x60,0x07,
+  18 ,0x44,0x36,0x14,0x19,0x55,0x58,0x36,0x49,0x98,0x02,0x70,0x28,0x55,0x77,0x33,0x23,0x30,0x04,
+  18 ,0x22,0x18,0x07,0x09,0x77,0x79,0x18,0x24,0x99,0x01,0x35,0x14,0x27,0x88,0x66,0x61,0x65,0x02,
+  18 ,0x11,0x09,0x03,0x54,0x88,0x89,0x59,0x12,0x49,0x50,0x67,0x57,0x13,0x94,0x33,0x30,0x82,0x51,
+  18 ,0x05,0x54,0x51,0x77,0x44,0x44,0x79,0x56,0x24,0x75,0x33,0x78,0x56,0x97,0x16,0x65,0x41,0x25,
+  18 ,0x02,0x77,0x25,0x88,0x72,0x22,0x39,0x78,0x12,0x37,0x66,0x89,0x28,0x48,0x58,0x32,0x70,0x63,
+  18 ,0x01,0x38,0x62,0x94,0x36,0x11,0x19,0x89,0x06,0x18,0x83,0x44,0x64,0x24,0x29,0x16,0x35,0x31,
+  17 ,0x69,0x31,0x47,0x18,0x05,0x59,0x94,0x53,0x09,0x41,0x72,0x32,0x12,0x14,0x58,0x17,0x66,
+  17 ,0x40,0x54,0x65,0x10,0x81,0x08,0x16,0x43,0x81,0x97,0x80,0x13,0x11,0x54,0x64,0x34,0x91,
+  17 ,0x22,0x31,0x43,0x55,0x13,0x14,0x20,0x97,0x55,0x76,0x62,0x95,0x09,0x03,0x09,0x83,0x45,
+  17 ,0x11,0x77,0x83,0x03,0x56,0x56,0x38,0x34,0x54,0x53,0x87,0x94,0x10,0x94,0x70,0x52,0x17,
+  17 ,0x06,0x06,0x24,0x62,0x18,0x16,0x43,0x48,0x42,0x58,0x06,0x06,0x13,0x20,0x40,0x42,0x03,
+  17 ,0x03,0x07,0x71,0x65,0x86,0x66,0x75,0x36,0x88,0x37,0x10,0x28,0x20,0x75,0x96,0x77,0x22,
+  17 ,0x01,0x55,0x04,0x18,0x65,0x35,0x96,0x52,0x54,0x15,0x08,0x54,0x04,0x60,0x42,0x44,0x68,
+  16 ,0x77,0x82,0x14,0x04,0x42,0x05,0x49,0x48,0x94,0x74,0x62,0x90,0x00,0x61,0x13,0x68,
+  16 ,0x38,0x98,0x64,0x04,0x15,0x65,0x73,0x23,0x01,0x39,0x37,0x34,0x30,0x95,0x84,0x29,
+  16 ,0x19,0x51,0x22,0x01,0x31,0x26,0x17,0x49,0x43,0x96,0x74,0x04,0x95,0x31,0x84,0x15,
+  16 ,0x09,0x76,0x08,0x59,0x73,0x05,0x54,0x58,0x89,0x59,0x60,0x82,0x49,0x08,0x01,0x72,
+  16 ,0x04,0x88,0x16,0x20,0x79,0x50,0x13,0x51,0x18,0x85,0x37,0x04,0x96,0x92,0x64,0x54,
+  16 ,0x02,0x44,0x11,0x08,0x27,0x52,0x73,0x62,0x70,0x91,0x60,0x47,0x90,0x85,0x82,0x35,
+  16 ,0x01,0x22,0x06,0x28,0x62,0x52,0x56,0x77,0x37,0x16,0x23,0x05,0x53,0x67,0x16,0x22,
+  15 ,0x61,0x03,0x32,0x93,0x68,0x06,0x38,0x52,0x49,0x13,0x15,0x87,0x89,0x64,0x90,
+  15 ,0x30,0x51,0x71,0x12,0x47,0x31,0x86,0x37,0x85,0x69,0x06,0x95,0x14,0x16,0x90,
+  15 ,0x15,0x25,0x86,0x72,0x64,0x83,0x62,0x39,0x74,0x05,0x75,0x73,0x25,0x13,0x49,
+  15 ,0x07,0x62,0x93,0x65,0x42,0x75,0x67,0x57,0x21,0x55,0x88,0x52,0x96,0x84,0x91,
+  15 ,0x03,0x81,0x46,0x89,0x98,0x96,0x85,0x88,0x94,0x80,0x71,0x17,0x84,0x97,0x68,
+  15 ,0x01,0x90,0x73,0x46,0x81,0x38,0x25,0x40,0x94,0x15,0x46,0x94,0x42,0x51,0x12,
+  14 ,0x95,0x36,0x73,0x86,0x16,0x59,0x18,0x82,0x33,0x90,0x84,0x15,0x51,0x50,
+  14 ,0x47,0x68,0x37,0x04,0x45,0x16,0x32,0x34,0x18,0x44,0x34,0x61,0x75,0x20,
+  14 ,0x23,0x84,0x18,0x55,0x06,0x79,0x85,0x75,0x87,0x10,0x42,0x36,0x79,0x47,
+  14 ,0x11,0x92,0x09,0x28,0x24,0x45,0x35,0x44,0x57,0x08,0x75,0x79,0x15,0x71,
+  14 ,0x05,0x96,0x04,0x64,0x29,0x99,0x03,0x38,0x56,0x18,0x58,0x25,0x31,0x77,
+  14 ,0x02,0x98,0x02,0x32,0x19,0x43,0x60,0x61,0x11,0x47,0x31,0x97,0x05,0x38,
+  14 ,0x01,0x49,0x01,0x16,0x10,0x82,0x82,0x53,0x54,0x89,0x03,0x91,0x81,0x70,
+  13 ,0x74,0x50,0x58,0x05,0x69,0x16,0x82,0x52,0x64,0x72,0x34,0x52,0x11,
+  13 ,0x37,0x25,0x29,0x02,0x91,0x52,0x30,0x20,0x17,0x58,0x25,0x70,0x10,
+  13 ,0x18,0x62,0x64,0x51,0x47,0x49,0x62,0x33,0x55,0x74,0x27,0x30,0x91,
+  13 ,0x09,0x31,0x32,0x25,0x74,0x18,0x17,0x97,0x64,0x69,0x00,0x06,0x27,
+  13 ,0x04,0x65,0x66,0x12,0x87,0x19,0x93,0x19,0x04,0x05,0x97,0x60,0x76,
+  13 ,0x02,0x32,0x83,0x06,0x43,0x62,0x67,0x64,0x57,0x45,0x98,0x31,0x96,
+  13 ,0x01,0x16,0x41,0x53,0x21,0x82,0x01,0x58,0x55,0x08,0x75,0x61,0x65,
+  12 ,0x58,0x20,0x76,0x60,0x91,0x17,0x73,0x34,0x13,0x32,0x11,0x96,
+  12 ,0x29,0x10,0x38,0x30,0x45,0x63,0x10,0x18,0x71,0x39,0x66,0x23,
+  12 ,0x14,0x55,0x19,0x15,0x22,0x82,0x60,0x97,0x26,0x88,0x23,0x49,
+  12 ,0x07,0x27,0x59,0x57,0x61,0x41,0x56,0x95,0x61,0x23,0x71,0x87,
+  12 ,0x03,0x63,0x79,0x78,0x80,0x70,0x85,0x09,0x55,0x06,0x75,0x97,
+  12 ,0x01,0x81,0x89,0x89,0x40,0x35,0x44,0x20,0x21,0x14,0x60,0x50,
+  11 ,0x90,0x94,0x94,0x70,0x17,0x72,0x51,0x46,0x47,0x60,0x88,
+  11 ,0x45,0x47,0x47,0x35,0x08,0x86,0x36,0x07,0x21,0x38,0x10,
+  11 ,0x22,0x73,0x73,0x67,0x54,0x43,0x20,0x62,0x10,0x08,0x46,
+  11 ,0x11,0x36,0x86,0x83,0x77,0x21,0x60,0x95,0x67,0x39,0x08,
+  11 ,0x05,0x68,0x43,0x41,0x88,0x60,0x80,0x63,0x99,0x28,0x26,
+  11 ,0x02,0x84,0x21,0x70,0x94,0x30,0x40,0x36,0x03,0x53,0x81,
+  11 ,0x01,0x42,0x10,0x85,0x47,0x15,0x20,0x19,0x02,0x74,0x32,
+  10 ,0x71,0x05,0x42,0x73,0x57,0x60,0x09,0x76,0x61,0x52,
+  10 ,0x35,0x52,0x71,0x36,0x78,0x80,0x04,0x94,0x61,0x85,
+  10 ,0x17,0x76,0x35,0x68,0x39,0x40,0x02,0x48,0x88,0x70,
+  10 ,0x08,0x88,0x17,0x84,0x19,0x70,0x01,0x24,0x83,0x79,
+  10 ,0x04,0x44,0x08,0x92,0x09,0x85,0x00,0x62,0x51,0x76,
+  10 ,0x02,0x22,0x04,0x46,0x04,0x92,0x50,0x31,0x28,0x34,
+  10 ,0x01,0x11,0x02,0x23,0x02,0x46,0x25,0x15,0x64,0x79,
+  9 ,0x55,0x51,0x11,0x51,0x23,0x12,0x57,0x82,0x55,
+  9 ,0x27,0x75,0x55,0x75,0x61,0x56,0x28,0x91,0x31,
+  9 ,0x13,0x87,0x77,0x87,0x80,0x78,0x14,0x45,0x67,
+  9 ,0x06,0x93,0x88,0x93,0x90,0x39,0x07,0x22,0x84,
+  9 ,0x03,0x46,0x94,0x46,0x95,0x19,0x53,0x61,0x42,
+  9 ,0x01,0x73,0x47,0x23,0x47,0x59,0x76,0x80,0x71,
+  8 ,0x86,0x73,0x61,0x73,0x79,0x88,0x40,0x35,
+  8 ,0x43,0x36,0x80,0x86,0x89,0x94,0x20,0x18,
+  8 ,0x21,0x68,0x40,0x43,0x44,0x97,0x10,0x09,
+  8 ,0x10,0x84,0x20,0x21,0x72,0x48,0x55,0x04,
+  8 ,0x05,0x42,0x10,0x10,0x86,0x24,0x27,0x52,
+  8 ,0x02,0x71,0x05,0x05,0x43,0x12,0x13,0x76,
+  8 ,0x01,0x35,0x52,0x52,0x71,0x56,0x06,0x88,
+  7 ,0x67,0x76,0x26,0x35,0x78,0x03,0x44,
+  7 ,0x33,0x88,0x13,0x17,0x89,0x01,0x72,
+  7 ,0x16,0x94,0x06,0x58,0x94,0x50,0x86,
+  7 ,0x08,0x47,0x03,0x29,0x47,0x25,0x43,
+  7 ,0x04,0x23,0x51,0x64,0x73,0x62,0x72,
+  7 ,0x02,0x11,0x75,0x82,0x36,0x81,0x36,
+  7 ,0x01,0x05,0x87,0x91,0x18,0x40,0x68,
+  6 ,0x52,0x93,0x95,0x59,0x20,0x34,
+  6 ,0x26,0x46,0x97,0x79,0x60,0x17,
+  6 ,0x13,0x23,0x48,0x89,0x80,0x08,
+  6 ,0x06,0x61,0x74,0x44,0x90,0x04,
+  6 ,0x03,0x30,0x87,0x22,0x45,0x02,
+  6 ,0x01,0x65,0x43,0x61,0x22,0x51,
+  5 ,0x82,0x71,0x80,0x61,0x26,
+  5 ,0x41,0x35,0x90,0x30,0x63,
+  5 ,0x20,0x67,0x95,0x15,0x31,
+  5 ,0x10,0x33,0x97,0x57,0x66,
+  5 ,0x05,0x16,0x98,0x78,0x83,
+  5 ,0x02,0x58,0x49,0x39,0x41,
+  5 ,0x01,0x29,0x24,0x69,0x71,
+  4 ,0x64,0x62,0x34,0x85,
+  4 ,0x32,0x31,0x17,0x43,
+  4 ,0x16,0x15,0x58,0x71,
+  4 ,0x08,0x07,0x79,0x36,
+  4 ,0x04,0x03,0x89,0x68,
+  4 ,0x02,0x01,0x94,0x84,
+  4 ,0x01,0x00,0x97,0x42,
+  3 ,0x50,0x48,0x71,
+  3 ,0x25,0x24,0x35,
+  3 ,0x12,0x62,0x18,
+  3 ,0x06,0x31,0x09,
+  3 ,0x03,0x15,0x54,
+  3 ,0x01,0x57,0x77,
+  2 ,0x78,0x89,
+  2 ,0x39,0x44,
+  2 ,0x19,0x72,
+  2 ,0x09,0x86,
+  2 ,0x04,0x93,
+  2 ,0x02,0x47,
+  2 ,0x01,0x23,
+  1 ,0x62,
+  1 ,0x31,
+  1 ,0x15,
+  1 ,0x08,
+  1 ,0x04,
+  1 ,0x02,
+  0};
+
+static const unsigned char TrigTable[]={
+  18 ,0x45,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+  18 ,0x26,0x56,0x50,0x51,0x17,0x70,0x77,0x98,0x93,0x51,0x57,0x21,0x93,0x72,0x04,0x53,0x29,0x47,
+  18 ,0x14,0x03,0x62,0x43,0x46,0x79,0x26,0x47,0x85,0x82,0x89,0x23,0x20,0x15,0x91,0x63,0x42,0x43,
+  18 ,0x07,0x12,0x50,0x16,0x34,0x89,0x01,0x79,0x75,0x61,0x95,0x33,0x00,0x84,0x12,0x06,0x84,0x47,
+  18 ,0x03,0x57,0x63,0x34,0x37,0x49,0x97,0x35,0x10,0x30,0x68,0x47,0x78,0x91,0x44,0x58,0x82,0x07,
+  18 ,0x01,0x78,0x99,0x10,0x60,0x82,0x46,0x06,0x93,0x07,0x15,0x02,0x49,0x77,0x60,0x79,0x09,0x47,
+  17 ,0x89,0x51,0x73,0x71,0x02,0x11,0x07,0x43,0x13,0x64,0x12,0x16,0x82,0x30,0x79,0x53,0x24,
+  17 ,0x44,0x76,0x14,0x17,0x08,0x60,0x55,0x30,0x73,0x09,0x43,0x53,0x82,0x54,0x23,0x82,0x25,
+  17 ,0x22,0x38,0x10,0x50,0x03,0x68,0x53,0x80,0x75,0x12,0x35,0x33,0x54,0x24,0x30,0x59,0x30,
+  17 ,0x11,0x19,0x05,0x67,0x70,0x66,0x20,0x68,0x87,0x27,0x54,0x75,0x79,0x70,0x34,0x72,0x50,
+  17 ,0x05,0x59,0x52,0x89,0x18,0x93,0x80,0x36,0x68,0x17,0x44,0x24,0x13,0x44,0x04,0x23,0x19,
+  17 ,0x02,0x79,0x76,0x45,0x26,0x17,0x00,0x36,0x74,0x59,0x91,0x79,0x11,0x92,0x36,0x82,0x97,
+  17 ,0x01,0x39,0x88,0x22,0x71,0x42,0x26,0x50,0x14,0x62,0x86,0x87,0x63,0x57,0x24,0x35,0x95,
+  16 ,0x69,0x94,0x11,0x36,0x75,0x35,0x29,0x18,0x45,0x75,0x24,0x89,0x32,0x87,0x81,0x60,
+  16 ,0x34,0x97,0x05,0x68,0x50,0x70,0x40,0x11,0x05,0x84,0x42,0x77,0x35,0x40,0x76,0x56,
+  16 ,0x17,0x48,0x52,0x84,0x26,0x98,0x04,0x49,0x52,0x15,0x80,0x88,0x73,0x44,0x17,0x76,
+  16 ,0x08,0x74,0x26,0x42,0x13,0x69,0x37,0x80,0x26,0x02,0x61,0x92,0x68,0x64,0x27,0x25,
+  16 ,0x04,0x37,0x13,0x21,0x06,0x87,0x23,0x34,0x56,0x75,0x78,0x22,0x83,0x81,0x83,0x35,
+  16 ,0x02,0x18,0x56,0x60,0x53,0x43,0x93,0x47,0x83,0x84,0x70,0x43,0x88,0x58,0x08,0x77,
+  16 ,0x01,0x09,0x28,0x30,0x26,0x72,0x00,0x71,0x48,0x85,0x70,0x39,0x80,0x29,0x57,0x96,
+  15 ,0x54,0x64,0x15,0x13,0x36,0x00,0x85,0x44,0x04,0x52,0x09,0x67,0x46,0x64,0x24,
+  15 ,0x27,0x32,0x07,0x56,0x68,0x00,0x48,0x93,0x22,0x46,0x91,0x06,0x02,0x51,0x48,
+  15 ,0x13,0x66,0x03,0x78,0x34,0x00,0x25,0x24,0x26,0x26,0x06,0x30,0x80,0x30,0x39,
+  15 ,0x06,0x83,0x01,0x89,0x17,0x00,0x12,0x71,0x83,0x75,0x85,0x75,0x12,0x54,0x51,
+  15 ,0x03,0x41,0x50,0x94,0x58,0x50,0x06,0x37,0x13,0x20,0x78,0x20,0x02,0x82,0x21,
+  15 ,0x01,0x70,0x75,0x47,0x29,0x25,0x03,0x18,0x71,0x76,0x99,0x76,0x57,0x22,0x98,
+  14 ,0x85,0x37,0x73,0x64,0x62,0x51,0x59,0x37,0x78,0x07,0x46,0x60,0x59,0x22,
+  14 ,0x42,0x68,0x86,0x82,0x31,0x25,0x79,0x69,0x12,0x73,0x43,0x09,0x29,0x33,
+  14 ,0x21,0x34,0x43,0x41,0x15,0x62,0x89,0x84,0x59,0x32,0x92,0x77,0x02,0x13,
+  14 ,0x10,0x67,0x21,0x70,0x57,0x81,0x44,0x92,0x30,0x03,0x49,0x03,0x80,0x75,
+  14 ,0x05,0x33,0x60,0x85,0x28,0x90,0x72,0x46,0x15,0x06,0x37,0x35,0x06,0x58,
+  14 ,0x02,0x66,0x80,0x42,0x64,0x45,0x36,0x23,0x07,0x53,0x76,0x52,0x92,0x82,
+  14 ,0x01,0x33,0x40,0x21,0x32,0x22,0x68,0x11,0x53,0x76,0x95,0x49,0x63,0x85,
+  13 ,0x66,0x70,0x10,0x66,0x11,0x34,0x05,0x76,0x88,0x48,0x65,0x21,0x61,
+  13 ,0x33,0x35,0x05,0x33,0x05,0x67,0x02,0x88,0x44,0x24,0x43,0x90,0x76,
+  13 ,0x16,0x67,0x52,0x66,0x52,0x83,0x51,0x44,0x22,0x12,0x23,0x36,0x63,
+  13 ,0x08,0x33,0x76,0x33,0x26,0x41,0x75,0x72,0x11,0x06,0x11,0x85,0x97,
+  13 ,0x04,0x16,0x88,0x16,0x63,0x20,0x87,0x86,0x05,0x53,0x05,0x95,0x19,
+  13 ,0x02,0x08,0x44,0x08,0x31,0x60,0x43,0x93,0x02,0x76,0x52,0x97,0x87,
+  13 ,0x01,0x04,0x22,0x04,0x15,0x80,0x21,0x96,0x51,0x38,0x26,0x48,0x97,
+  12 ,0x52,0x11,0x02,0x07,0x90,0x10,0x98,0x25,0x69,0x13,0x24,0x49,
+  12 ,0x26,0x05,0x51,0x03,0x95,0x05,0x49,0x12,0x84,0x56,0x62,0x25,
+  12 ,0x13,0x02,0x75,0x51,0x97,0x52,0x74,0x56,0x42,0x28,0x31,0x12,
+  12 ,0x06,0x51,0x37,0x75,0x98,0x76,0x37,0x28,0x21,0x14,0x15,0x56,
+  12 ,0x03,0x25,0x68,0x87,0x99,0x38,0x18,0x64,0x10,0x57,0x07,0x78,
+  12 ,0x01,0x62,0x84,0x43,0x99,0x69,0x09,0x32,0x05,0x28,0x53,0x89,
+  11 ,0x81,0x42,0x21,0x99,0x84,0x54,0x66,0x02,0x64,0x26,0x95,
+  11 ,0x40,0x71,0x10,0x99,0x92,0x27,0x33,0x01,0x32,0x13,0x47,
+  11 ,0x20,0x35,0x55,0x49,0x96,0x13,0x66,0x50,0x66,0x06,0x74,
+  11 ,0x10,0x17,0x77,0x74,0x98,0x06,0x83,0x25,0x33,0x03,0x37,
+  11 ,0x05,0x08,0x88,0x87,0x49,0x03,0x41,0x62,0x66,0x51,0x68,
+  11 ,0x02,0x54,0x44,0x43,0x74,0x51,0x70,0x81,0x33,0x25,0x84,
+  11 ,0x01,0x27,0x22,0x21,0x87,0x25,0x85,0x40,0x66,0x62,0x92,
+  10 ,0x63,0x61,0x10,0x93,0x62,0x92,0x70,0x33,0x31,0x46,
+  10 ,0x31,0x80,0x55,0x46,0x81,0x46,0x35,0x16,0x65,0x73,
+  10 ,0x15,0x90,0x27,0x73,0x40,0x73,0x17,0x58,0x32,0x87,
+  10 ,0x07,0x95,0x13,0x86,0x70,0x36,0x58,0x79,0x16,0x43,
+  10 ,0x03,0x97,0x56,0x93,0x35,0x18,0x29,0x39,0x58,0x22,
+  10 ,0x01,0x98,0x78,0x46,0x67,0x59,0x14,0x69,0x79,0x11,
+  9 ,0x99,0x39,0x23,0x33,0x79,0x57,0x34,0x89,0x55,
+  9 ,0x49,0x69,0x61,0x66,0x89,0x78,0x67,0x44,0x78,
+  9 ,0x24,0x84,0x80,0x83,0x44,0x89,0x33,0x72,0x39,
+  9 ,0x12,0x42,0x40,0x41,0x72,0x44,0x66,0x86,0x19,
+  9 ,0x06,0x21,0x20,0x20,0x86,0x22,0x33,0x43,0x10,
+  9 ,0x03,0x10,0x60,0x10,0x43,0x11,0x16,0x71,0x55,
+  9 ,0x01,0x55,0x30,0x05,0x21,0x55,0x58,0x35,0x77,
+  8 ,0x77,0x65,0x02,0x60,0x77,0x79,0x17,0x89,
+  8 ,0x38,0x82,0x51,0x30,0x38,0x89,0x58,0x94,
+  8 ,0x19,0x41,0x25,0x65,0x19,0x44,0x79,0x47,
+  8 ,0x09,0x70,0x62,0x82,0x59,0x72,0x39,0x74,
+  8 ,0x04,0x85,0x31,0x41,0x29,0x86,0x19,0x87,
+  8 ,0x02,0x42,0x65,0x70,0x64,0x93,0x09,0x93,
+  8 ,0x01,0x21,0x32,0x85,0x32,0x46,0x54,0x97,
+  7 ,0x60,0x66,0x42,0x66,0x23,0x27,0x48,
+  7 ,0x30,0x33,0x21,0x33,0x11,0x63,0x74,
+  7 ,0x15,0x16,0x60,0x66,0x55,0x81,0x87,
+  7 ,0x07,0x58,0x30,0x33,0x27,0x90,0x94,
+  7 ,0x03,0x79,0x15,0x16,0x63,0x95,0x47,
+  7 ,0x01,0x89,0x57,0x58,0x31,0x97,0x73,
+  6 ,0x94,0x78,0x79,0x15,0x98,0x87,
+  6 ,0x47,0x39,0x39,0x57,0x99,0x43,
+  6 ,0x23,0x69,0x69,0x78,0x99,0x72,
+  6 ,0x11,0x84,0x84,0x89,0x49,0x86,
+  6 ,0x05,0x92,0x42,0x44,0x74,0x93,
+  6 ,0x02,0x96,0x21,0x22,0x37,0x46,
+  6 ,0x01,0x48,0x10,0x61,0x18,0x73,
+  5 ,0x74,0x05,0x30,0x59,0x37,
+  5 ,0x37,0x02,0x65,0x29,0x68,
+  5 ,0x18,0x51,0x32,0x64,0x84,
+  5 ,0x09,0x25,0x66,0x32,0x42,
+  5 ,0x04,0x62,0x83,0x16,0x21,
+  5 ,0x02,0x31,0x41,0x58,0x11,
+  5 ,0x01,0x15,0x70,0x79,0x05,
+  4 ,0x57,0x85,0x39,0x53,
+  4 ,0x28,0x92,0x69,0x76,
+  4 ,0x14,0x46,0x34,0x88,
+  4 ,0x07,0x23,0x17,0x44,
+  4 ,0x03,0x61,0x58,0x72,
+  4 ,0x01,0x80,0x79,0x36,
+  3 ,0x90,0x39,0x68,
+  3 ,0x45,0x19,0x84,
+  3 ,0x22,0x59,0x92,
+  3 ,0x11,0x29,0x96,
+  3 ,0x05,0x64,0x98,
+  3 ,0x02,0x82,0x49,
+  3 ,0x01,0x41,0x25,
+  2 ,0x70,0x62,
+  2 ,0x35,0x31,
+  2 ,0x17,0x66,
+  2 ,0x08,0x83,
+  2 ,0x04,0x41,
+  2 ,0x02,0x21,
+  2 ,0x01,0x10,
+  1 ,0x55,
+  1 ,0x28,
+  1 ,0x14,
+  1 ,0x07,
+  1 ,0x03,
+  1 ,0x02,
+  0};
+
+static const unsigned char HypTable[]={
+  17 ,0x54,0x93,0x06,0x14,0x43,0x34,0x05,0x48,0x45,0x69,0x76,0x22,0x61,0x84,0x61,0x26,0x29,
+  17 ,0x25,0x54,0x12,0x81,0x18,0x82,0x99,0x53,0x41,0x60,0x27,0x57,0x04,0x81,0x51,0x83,0x10,
+  17 ,0x12,0x56,0x57,0x21,0x41,0x40,0x45,0x30,0x38,0x84,0x25,0x68,0x86,0x52,0x00,0x93,0x58,
+  17 ,0x06,0x25,0x81,0x57,0x14,0x77,0x00,0x30,0x07,0x12,0x67,0x65,0x02,0x38,0x62,0x20,0x66,
+  17 ,0x03,0x12,0x60,0x17,0x84,0x90,0x66,0x69,0x94,0x76,0x40,0x12,0x24,0x51,0x72,0x64,0x89,
+  17 ,0x01,0x56,0x26,0x27,0x17,0x52,0x05,0x22,0x11,0x37,0x92,0x01,0x77,0x87,0x51,0x63,0x76,
+  16 ,0x78,0x12,0x65,0x89,0x51,0x54,0x04,0x20,0x91,0x03,0x23,0x47,0x12,0x76,0x04,0x02,
+  16 ,0x39,0x06,0x26,0x98,0x68,0x39,0x68,0x26,0x05,0x31,0x27,0x56,0x33,0x69,0x70,0x78,
+  16 ,0x19,0x53,0x12,0x74,0x83,0x53,0x25,0x49,0x99,0x86,0x50,0x77,0x08,0x86,0x85,0x42,
+  16 ,0x09,0x76,0x56,0x28,0x10,0x44,0x10,0x35,0x84,0x09,0x64,0x45,0x00,0x29,0x88,0x53,
+  16 ,0x04,0x88,0x28,0x12,0x88,0x80,0x51,0x12,0x82,0x67,0x61,0x00,0x66,0x26,0x27,0x12,
+  16 ,0x02,0x44,0x14,0x06,0x29,0x85,0x06,0x38,0x58,0x29,0x27,0x97,0x22,0x52,0x10,0x24,
+  16 ,0x01,0x22,0x07,0x03,0x13,0x10,0x63,0x29,0x80,0x66,0x02,0x96,0x30,0x78,0x73,0x71,
+  15 ,0x61,0x03,0x51,0x56,0x32,0x57,0x91,0x22,0x53,0x17,0x15,0x06,0x09,0x72,0x79,
+  15 ,0x30,0x51,0x75,0x78,0x13,0x44,0x73,0x90,0x31,0x48,0x76,0x19,0x58,0x40,0x21,
+  15 ,0x15,0x25,0x87,0x89,0x06,0x36,0x84,0x23,0x78,0x93,0x09,0x89,0x36,0x43,0x23,
+  15 ,0x07,0x62,0x93,0x94,0x53,0x13,0x98,0x02,0x97,0x36,0x62,0x18,0x57,0x41,0x76,
+  15 ,0x03,0x81,0x46,0x97,0x26,0x56,0x43,0x50,0x37,0x17,0x07,0x72,0x47,0x50,0x11,
+  15 ,0x01,0x90,0x73,0x48,0x63,0x28,0x14,0x81,0x29,0x64,0x63,0x46,0x40,0x79,0x15,
+  14 ,0x95,0x36,0x74,0x31,0x64,0x06,0x53,0x91,0x20,0x57,0x93,0x29,0x62,0x56,
+  14 ,0x47,0x68,0x37,0x15,0x82,0x03,0x16,0x11,0x40,0x07,0x24,0x16,0x18,0x84,
+  14 ,0x23,0x84,0x18,0x57,0x91,0x01,0x56,0x70,0x17,0x50,0x90,0x52,0x02,0x31,
+  14 ,0x11,0x92,0x09,0x28,0x95,0x50,0x78,0x18,0x14,0x68,0x86,0x31,0x50,0x29,
+  14 ,0x05,0x96,0x04,0x64,0x47,0x75,0x39,0x06,0x95,0x58,0x60,0x78,0x93,0x79,
+  14 ,0x02,0x98,0x02,0x32,0x23,0x87,0x69,0x53,0x21,0x32,0x32,0x59,0x86,0x72,
+  14 ,0x01,0x49,0x01,0x16,0x11,0x93,0x84,0x76,0x57,0x35,0x29,0x07,0x48,0x34,
+  13 ,0x74,0x50,0x58,0x05,0x96,0x92,0x38,0x28,0x26,0x28,0x63,0x43,0x54,
+  13 ,0x37,0x25,0x29,0x02,0x98,0x46,0x19,0x14,0x07,0x97,0x32,0x92,0x94,
+  13 ,0x18,0x62,0x64,0x51,0x49,0x23,0x09,0x57,0x03,0x34,0x04,0x11,0x62,
+  13 ,0x09,0x31,0x32,0x25,0x74,0x61,0x54,0x78,0x51,0x58,0x94,0x26,0x45,
+  13 ,0x04,0x65,0x66,0x12,0x87,0x30,0x77,0x39,0x25,0x78,0x46,0x15,0x81,
+  13 ,0x02,0x32,0x83,0x06,0x43,0x65,0x38,0x69,0x62,0x89,0x10,0x45,0x73,
+  13 ,0x01,0x16,0x41,0x53,0x21,0x82,0x69,0x34,0x81,0x44,0x53,0x65,0x09,
+  12 ,0x58,0x20,0x76,0x60,0x91,0x34,0x67,0x40,0x72,0x26,0x62,0x82,
+  12 ,0x29,0x10,0x38,0x30,0x45,0x67,0x33,0x70,0x36,0x13,0x28,0x95,
+  12 ,0x14,0x55,0x19,0x15,0x22,0x83,0x66,0x85,0x18,0x06,0x64,0x17,
+  12 ,0x07,0x27,0x59,0x57,0x61,0x41,0x83,0x42,0x59,0x03,0x32,0x04,
+  12 ,0x03,0x63,0x79,0x78,0x80,0x70,0x91,0x71,0x29,0x51,0x66,0x02,
+  12 ,0x01,0x81,0x89,0x89,0x40,0x35,0x45,0x85,0x64,0x75,0x83,0x01,
+  11 ,0x90,0x94,0x94,0x70,0x17,0x72,0x92,0x82,0x37,0x91,0x50,
+  11 ,0x45,0x47,0x47,0x35,0x08,0x86,0x46,0x41,0x18,0x95,0x75,
+  11 ,0x22,0x73,0x73,0x67,0x54,0x43,0x23,0x20,0x59,0x47,0x88,
+  11 ,0x11,0x36,0x86,0x83,0x77,0x21,0x61,0x60,0x29,0x73,0x94,
+  11 ,0x05,0x68,0x43,0x41,0x88,0x60,0x80,0x80,0x14,0x86,0x97,
+  11 ,0x02,0x84,0x21,0x70,0x94,0x30,0x40,0x40,0x07,0x43,0x48,
+  11 ,0x01,0x42,0x10,0x85,0x47,0x15,0x20,0x20,0x03,0x71,0x74,
+  10 ,0x71,0x05,0x42,0x73,0x57,0x60,0x10,0x01,0x85,0x87,
+  10 ,0x35,0x52,0x71,0x36,0x78,0x80,0x05,0x00,0x92,0x94,
+  10 ,0x17,0x76,0x35,0x68,0x39,0x40,0x02,0x50,0x46,0x47,
+  10 ,0x08,0x88,0x17,0x84,0x19,0x70,0x01,0x25,0x23,0x23,
+  10 ,0x04,0x44,0x08,0x92,0x09,0x85,0x00,0x62,0x61,0x62,
+  10 ,0x02,0x22,0x04,0x46,0x04,0x92,0x50,0x31,0x30,0x81,
+  10 ,0x01,0x11,0x02,0x23,0x02,0x46,0x25,0x15,0x65,0x40,
+  9 ,0x55,0x51,0x11,0x51,0x23,0x12,0x57,0x82,0x70,
+  9 ,0x27,0x75,0x55,0x75,0x61,0x56,0x28,0x91,0x35,
+  9 ,0x13,0x87,0x77,0x87,0x80,0x78,0x14,0x45,0x68,
+  9 ,0x06,0x93,0x88,0x93,0x90,0x39,0x07,0x22,0x84,
+  9 ,0x03,0x46,0x94,0x46,0x95,0x19,0x53,0x61,0x42,
+  9 ,0x01,0x73,0x47,0x23,0x47,0x59,0x76,0x80,0x71,
+  8 ,0x86,0x73,0x61,0x73,0x79,0x88,0x40,0x35,
+  8 ,0x43,0x36,0x80,0x86,0x89,0x94,0x20,0x18,
+  8 ,0x21,0x68,0x40,0x43,0x44,0x97,0x10,0x09,
+  8 ,0x10,0x84,0x20,0x21,0x72,0x48,0x55,0x04,
+  8 ,0x05,0x42,0x10,0x10,0x86,0x24,0x27,0x52,
+  8 ,0x02,0x71,0x05,0x05,0x43,0x12,0x13,0x76,
+  8 ,0x01,0x35,0x52,0x52,0x71,0x56,0x06,0x88,
+  7 ,0x67,0x76,0x26,0x35,0x78,0x03,0x44,
+  7 ,0x33,0x88,0x13,0x17,0x89,0x01,0x72,
+  7 ,0x16,0x94,0x06,0x58,0x94,0x50,0x86,
+  7 ,0x08,0x47,0x03,0x29,0x47,0x25,0x43,
+  7 ,0x04,0x23,0x51,0x64,0x73,0x62,0x72,
+  7 ,0x02,0x11,0x75,0x82,0x36,0x81,0x36,
+  7 ,0x01,0x05,0x87,0x91,0x18,0x40,0x68,
+  6 ,0x52,0x93,0x95,0x59,0x20,0x34,
+  6 ,0x26,0x46,0x97,0x79,0x60,0x17,
+  6 ,0x13,0x23,0x48,0x89,0x80,0x08,
+  6 ,0x06,0x61,0x74,0x44,0x90,0x04,
+  6 ,0x03,0x30,0x87,0x22,0x45,0x02,
+  6 ,0x01,0x65,0x43,0x61,0x22,0x51,
+  5 ,0x82,0x71,0x80,0x61,0x26,
+  5 ,0x41,0x35,0x90,0x30,0x63,
+  5 ,0x20,0x67,0x95,0x15,0x31,
+  5 ,0x10,0x33,0x97,0x57,0x66,
+  5 ,0x05,0x16,0x98,0x78,0x83,
+  5 ,0x02,0x58,0x49,0x39,0x41,
+  5 ,0x01,0x29,0x24,0x69,0x71,
+  4 ,0x64,0x62,0x34,0x85,
+  4 ,0x32,0x31,0x17,0x43,
+  4 ,0x16,0x15,0x58,0x71,
+  4 ,0x08,0x07,0x79,0x36,
+  4 ,0x04,0x03,0x89,0x68,
+  4 ,0x02,0x01,0x94,0x84,
+  4 ,0x01,0x00,0x97,0x42,
+  3 ,0x50,0x48,0x71,
+  3 ,0x25,0x24,0x35,
+  3 ,0x12,0x62,0x18,
+  3 ,0x06,0x31,0x09,
+  3 ,0x03,0x15,0x54,
+  3 ,0x01,0x57,0x77,
+  2 ,0x78,0x89,
+  2 ,0x39,0x44,
+  2 ,0x19,0x72,
+  2 ,0x09,0x86,
+  2 ,0x04,0x93,
+  2 ,0x02,0x47,
+  2 ,0x01,0x23,
+  1 ,0x62,
+  1 ,0x31,
+  1 ,0x15,
+  1 ,0x08,
+  1 ,0x04,
+  1 ,0x02,
+  0};
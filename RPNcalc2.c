@@ -2,34 +2,143 @@
 #include <LPC11xx.h>
 #include <LPC_init.h>
 #include <PinGPIO.h>
+#include "MathTables.h"
 
 #define DELAY_TIME 48000
 
 #define SPI_READ  0x03
 #define SPI_WRITE 0x02
+#define RAM_CHUNK 16 //bytes CopyBCD moves per read and write
 
 #define BCD_SIGN 0
 #define BCD_LEN  1
 #define BCD_DEC  2
 
-#define STACK_SIZE 200
+//BCD_stack shares SRAM bank 0 with the tables so tables past 48 digits get
+//half the stack
+#if MATH_DIGITS>48
+#define STACK_SIZE  100
+#define STACK_BYTES 12000 //STACK_SIZE*MATH_CELL_SIZE
+#else
+#define STACK_SIZE  200
+#define STACK_BYTES 24000 //STACK_SIZE*MATH_CELL_SIZE
+#endif
 
 #define MATH_CELL_SIZE 120
-#define MATH_ENTRY_SIZE 37
-#define MATH_LOG_TABLE 114
-#define MATH_TRIG_TABLE 113
+//MATH_DIGITS, table sizes, K, log10_factor, pi and deg_factor come from
+//MathTables.h so the constants always have as many digits as the tables
 
-#define K             "0.60725293500888125616944675250493"
-#define log10_factor  "2.30258509299404568401799145468437"
-#define pi            "3.1415926535897932384626433832795"
-#define pi2           "1.57079632679489661923132169163975"
-#define rad_factor    "0.01745329251994329576923690768489"
-#define deg_factor    "57.29577951308232087679815481410522"
+//MultBCD keeps the whole product of two numbers with MATH_DIGITS places
+//and a whole digit in a cell
+#if (2*(MATH_DIGITS+1)+3)>MATH_CELL_SIZE
+#error "MathTables.h has more digits than MATH_CELL_SIZE can multiply"
+#endif
 
 #define COMP_GT 0
 #define COMP_LT 1
 #define COMP_EQ 2
 
+//CalcTanBCD modes
+#define CORDIC_ROTATE 0
+#define CORDIC_VECTOR 1
+#define CORDIC_HYP    2
+
+//Tables for TableEntry
+#define TABLE_LOG  0
+#define TABLE_TRIG 1
+#define TABLE_HYP  2
+
+//Hot table cache. Leading entries of each table at the current precision
+//packed into internal RAM by SetTables. Entry is number of leading zero
+//digits then the rest of the digits 2 per byte
+#define HOT_BYTES   320
+#define HOT_ENTRIES 32
+
+//Short numbers. + - * / on operands with no more significant digits than
+//this are done on 64 bit integers and a count of decimal places
+#define SHORT_DIGITS 18
+#define SHORT_MAX    999999999999999999ULL
+
+//Working precision. Results inside calculations are cut to DecPlaces plus
+//this many decimals and only rounded to DecPlaces when they're committed to
+//the stack. DecPlaces goes up to MATH_DIGITS-GUARD_DIGITS so the tables
+//have the guard digits too
+#define GUARD_DIGITS 2
+
+//MultBCD and DivBCD work on 4 digit limbs. A column of limb products for a
+//full cell still fits in 32 bits
+#define LIMB_DIGITS 4
+#define LIMB_BASE   10000
+#define LIMBS       ((MATH_CELL_SIZE+LIMB_DIGITS-1)/LIMB_DIGITS)
+
+//High precision worksheet. Numbers of HP_DIGITS_MIN-HP_DIGITS_MAX digits live
+//in external RAM as a header then limbs, most significant first:
+//0.limb0 limb1 ... * LIMB_BASE^exp with limb0 non-zero unless len is 0
+//Kernels only hold HP_WINDOW limbs of an operand in internal RAM at a time
+#define HP_DIGITS_MIN  100
+#define HP_DIGITS_MAX  500
+#define HP_GUARD_LIMBS 2
+#define HP_LIMBS_MAX   128 //HP_DIGITS_MAX/LIMB_DIGITS+HP_GUARD_LIMBS+1 for HpLn
+#define HP_HEADER      4   //sign, len, exp (2 bytes)
+#define HP_CELL_SIZE   260 //HP_HEADER+2*HP_LIMBS_MAX
+#define HP_WINDOW      16
+//Smallest top square HpMult splits. One split saves a quarter of its blocks
+//but the sums and the middle pass cost more SPI traffic than that until the
+//square is 64 limbs, which is 6-10% fewer cycles from 96 limbs up
+#define HP_KARATSUBA   64
+#define HP_LEVELS      4
+#define HP_TEMPS       18
+#define HP_STEPS       8   //Newton steps from 4 limbs to HP_LIMBS_MAX
+#define HP_AGM_MAX     40
+#define HP_PI_STEPS    12  //keeps the 2^k in HpPi below LIMB_BASE
+#define HP_LN_SCALE    8192 //largest power of 2 below LIMB_BASE
+#define HP_LN_BITS     13   //2^HP_LN_BITS is HP_LN_SCALE
+
+#define HP_SIGN 0
+#define HP_LEN  1
+#define HP_EXP  2
+
+#define HP_T(i)     (hp_temps+(i)*HP_CELL_SIZE)
+#define HP_LEVEL(i) (hp_stack+(i)*HP_CELL_SIZE)
+
+//Cache of transcendental results in external RAM
+//Entry is op, DecPlaces, DegRad, checksum then three cells:
+//argument, second argument or second result, result
+#define CACHE_LN   1
+#define CACHE_EXP  2
+#define CACHE_TAN  3
+#define CACHE_ATAN 4
+#define CACHE_POW  5
+
+#define CACHE_SIZE   16
+#define CACHE_HEADER 4
+#define CACHE_ENTRY_SIZE (CACHE_HEADER+3*MATH_CELL_SIZE)
+
+//Progressive precision. Transcendental keys show a result at QUICK_PLACES
+//first then refine to DecPlaces between key presses
+//refine_cells holds arguments (2 cells), the quick result and the input line
+#define QUICK_PLACES  8
+#define REFINE_QUICK  (2*MATH_CELL_SIZE)
+#define REFINE_INPUT  (3*MATH_CELL_SIZE)
+
+//Idle time speculation. Likely next keys on X are worked out while waiting
+//for a key and kept in spec_cells with the stack_version they were made for
+//Last cell is a copy of X
+#define SPEC_KEYS  5
+#define SPEC_X     (SPEC_KEYS*MATH_CELL_SIZE)
+
+//Deferred results while a program runs. A node says the cell at level holds
+//the operand of op rather than its result, and for two operand ops the
+//other operand is in lazy_cells. Nodes are worked out when a key needs the
+//value or the program ends unless the key can fuse with them
+#define LAZY_NODES  2
+#define LAZY_NONE   0
+#define LAZY_SQUARE 1 //x^2
+#define LAZY_SUMSQ  2 //x^2+y^2
+#define LAZY_MULT   3 //x*y
+#define LAZY_LN     4
+#define LAZY_EXP    5
+
 #define PROG_COUNT  10
 #define PROG_SIZE   4000
 #define PROG_HEADER 10  //name(9) + 0
@@ -45,17 +154,27 @@
 #define KEY_UP        72*/
 
 #define SCREEN_WIDTH 18
+#define SCREEN_ROWS  4
+//Unchanged characters LCD_Flush rewrites rather than sending a gotoxy
+#define LCD_GAP      6
+//Most CR, BS or HT bytes LCD_Cursor sends before a gotoxy is shorter
+#define LCD_STEPS    5
+//Power of 2. Big enough for a whole screen of changes
+#define LCD_QUEUE    128
 
 enum KEYS {KEY_NONE=0,KEY_CLEAR,KEY_SIGN,KEY_DUPE,KEY_ENTER,KEY_SWAP,KEY_FN,
            KEY_PROG,KEY_LEFT,KEY_DOWN,KEY_RIGHT,KEY_2ND,KEY_SQRT,KEY_XRTY,KEY_UP,
            KEY_BACKSPACE,KEY_MOD,KEY_COS,KEY_ACOS,KEY_EX,KEY_10X,KEY_LN,KEY_LOG,KEY_1X,
            KEY_ROUND,KEY_POW,KEY_SIN,KEY_ASIN,KEY_TAN,KEY_ATAN,KEY_SETTINGS,KEY_X2,
-           KEY_ESCAPE,KEY_DELETE,KEY_EXEC,KEY_INS};
+           KEY_ESCAPE,KEY_DELETE,KEY_EXEC,KEY_INS,
+           KEY_SINH,KEY_COSH,KEY_TANH,KEY_ASINH,KEY_ACOSH,KEY_ATANH,
+           KEY_HIPREC=':'};
 
 //KEY_EXEC is a virtual key used to run programs
 //* is 42, 9 is 57
 //KEY_EXEC is 35
 //Could leave hole after '9'
+//KEY_HIPREC is past '9' since ATANH is 41 already
 static const char KeyMatrix[]={0 ,KEY_CLEAR,'0','.',KEY_SIGN,'+',
                                   KEY_DUPE,'1','2','3','-',
                                   KEY_SWAP,'4','5','6','*',
@@ -63,20 +182,61 @@ static const char KeyMatrix[]={0 ,KEY_CLEAR,'0','.',KEY_SIGN,'+',
                                   KEY_FN,KEY_PROG,KEY_LEFT,KEY_DOWN,KEY_RIGHT,
                                   KEY_2ND,KEY_SQRT,KEY_XRTY,KEY_UP,KEY_BACKSPACE};
 
-static const char KeyMatrix2nd[]={0,KEY_10X,KEY_ROUND,0,0,0,
+static const char KeyMatrix2nd[]={0,KEY_10X,KEY_ROUND,KEY_HIPREC,0,0,
                                     KEY_LOG,KEY_SIN,KEY_COS,KEY_TAN,0,
                                     KEY_EX,KEY_X2,KEY_POW,KEY_1X,0,
                                     KEY_LN,KEY_ASIN,KEY_ACOS,KEY_ATAN,KEY_MOD,
                                     0,KEY_SETTINGS,0,0,0,
                                     0,KEY_INS,KEY_XRTY,0,KEY_ESCAPE};
 
+//2nd then Fn
+static const char KeyMatrixHyp[]={0,0,0,0,0,0,
+                                    0,KEY_SINH,KEY_COSH,KEY_TANH,0,
+                                    0,0,0,0,0,
+                                    0,KEY_ASINH,KEY_ACOSH,KEY_ATANH,0,
+                                    0,0,0,0,0,
+                                    0,0,0,0,0};
+
+//Keys worth working out ahead of time
+static const char SpecKeys[SPEC_KEYS]={KEY_1X,KEY_X2,KEY_SQRT,KEY_LN,KEY_SIN};
+
+//Stands in for the digits an operand doesn't have in AddDigits
+static const unsigned char zero_digits[MATH_CELL_SIZE]={0};
+
 struct SettingsType
 {
   int DecPlaces;
   bool DegRad;
   unsigned int LogTableSize;
   unsigned int TrigTableSize;
+  unsigned int HypTableSize;
   bool SciNot;
+  int WorkPlaces;
+  int TablePlaces;
+  int HpDigits;
+  int HpLimbs;
+};
+
+//Row DrawStack made for a stack level. level is -1 when unused
+struct DrawType
+{
+  int level;
+  bool sci;
+  unsigned char places;
+  char text[SCREEN_WIDTH];
+};
+
+struct LazyType
+{
+  unsigned char op;
+  unsigned char level;
+};
+
+struct HpHeadType
+{
+  unsigned char sign;
+  int len;
+  int exp;
 };
 
 #pragma MM_READ RAM_Read
@@ -86,10 +246,17 @@ struct SettingsType
 static void Calc_Init();
 
 static void LCD_Byte(unsigned char data);
+static void LCD_Next();
+static void LCD_Send(unsigned char data);
 static void LCD_Text(const char *data);
 static void LCD_Hex(unsigned char value);
 static void LCD_Hex8(unsigned char value);
 static void LCD_Init();
+static void LCD_Put(unsigned char data);
+static void LCD_Clear();
+static void LCD_Flush();
+static void LCD_Cursor(short x, short y);
+static void LCD_Blink(bool status);
 
 static unsigned char SPI_Send(unsigned char value);
 static void SPI_Text(const char *data);
@@ -100,31 +267,51 @@ static void Key_Init();
 static void SetBlink(bool status);
 static void gotoxy(short x, short y);
 static unsigned char GetKey();
+static bool KeyWaiting();
 
+static void RAM_Start(unsigned char command, const unsigned char *a1);
 static void RAM_Write(const unsigned char *a1, const unsigned char byte);
 static unsigned char RAM_Read(const unsigned char *a1);
+static void RAM_ReadBlock(unsigned char *dest, const unsigned char *a1, unsigned int count);
+static void RAM_WriteBlock(const unsigned char *a1, const unsigned char *src, unsigned int count);
 
 static void MakeTables();
+static void UnpackTable(unsigned char *dest, const unsigned char *table);
 static void SetDecPlaces();
-static void ImmedBCD(const char *text, unsigned char *BCD);
-static void BufferBCD_EtI(const unsigned char *text, unsigned char *BCD);
-static void BufferBCD_ItE(const unsigned char *text, unsigned char *BCD);
+static void SetTables();
+static unsigned char *TableBase(unsigned char table);
+static void HotBuild();
+static bool HotPack(unsigned char *entry, unsigned int *used);
+static void TableEntry(unsigned char *dest, unsigned char table, unsigned int i);
 static void BufferBCD_ItI(const unsigned char *text, unsigned char *BCD);
 static void ImmedBCD_RAM(const char *text, unsigned char *BCD);
 static void BufferBCD_ItI(const unsigned char *text, unsigned char *BCD);
 static bool IsZero(unsigned char *n1);
 static bool IsZero_RAM(unsigned char *n1);
 static void AddBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2);
-static void SubBCD(unsigned char *result, const unsigned char *n1, unsigned char *n2);
+static void SumBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2, unsigned char negate);
+static unsigned char AddDigits(unsigned char *out, const unsigned char *a, const unsigned char *b, int count, unsigned char complement, unsigned char carry);
+static void SubBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2);
 static void PrintBCD(const unsigned char *BCD, int dec_point);
 static void PrintBCD_RAM(const unsigned char *BCD, int dec_point);
 static void MultBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2);
+static void SquareBCD(unsigned char *result, const unsigned char *n1);
 static void DivBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2);
-static void ShrinkBCD(unsigned char *dest,unsigned char *src);
-static void ShrinkBCD_RAM(unsigned char *dest,unsigned char *src);
-static void FullShrinkBCD(unsigned char *n1);
+static int ToLimbs(unsigned short *limbs, const unsigned char *n1, int count);
+static int FromLimb(unsigned char *result, int ptr, unsigned int limb);
+static void LimbSub(unsigned short *rem, const unsigned short *div, int div_len, unsigned long amount);
+static bool LimbComp(const unsigned short *rem, const unsigned short *div, int div_len);
+static void LimbMult(unsigned short *prod, const unsigned short *a, int a_len, const unsigned short *b, int b_len);
+static void LimbSquare(unsigned short *prod, const unsigned short *a, int n);
+static bool ShortBCD(const unsigned char *n1, unsigned long long *value, int *scale);
+static void ShortToBCD(unsigned char *result, unsigned long long value, int scale, unsigned char sign);
+static int ShortDigits(unsigned long long value);
+static bool ShortMathBCD(unsigned char op, unsigned char *result, const unsigned char *n1, const unsigned char *n2);
+static bool ShortDivBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2);
 static void FullShrinkBCD_RAM(unsigned char *n1);
-static void PadBCD(unsigned char *n1, int amount);
+static void CommitBCD(unsigned char *cell, unsigned char *n1);
+static void TrimBCD(unsigned char *n1);
+static void RoundBCD(unsigned char *n1, int places);
 static void PadBCD_RAM(unsigned char *n1, int amount);
 static void CopyBCD(unsigned char *dest, unsigned char *src);
 static void CopyBCD_EtI(unsigned char *dest, unsigned char *src);
@@ -140,82 +327,226 @@ static void AcosBCD(unsigned char *result,unsigned char *arg);
 static void AsinBCD(unsigned char *result,unsigned char *arg);
 static void AtanBCD(unsigned char *result,unsigned char *arg);
 static void CalcTanBCD(unsigned char *result1,unsigned char *result2,unsigned char *result3,unsigned char *arg,unsigned char flag);
+static void HypBCD(unsigned char *sinh_result,unsigned char *cosh_result,unsigned char *arg);
+static void AsinhBCD(unsigned char *result,unsigned char *arg);
+static void AcoshBCD(unsigned char *result,unsigned char *arg);
+static void AtanhBCD(unsigned char *result,unsigned char *arg);
+static void SqrtHypBCD(unsigned char *result,unsigned char *arg);
+static void HypotBCD(unsigned char *result,unsigned char *a,unsigned char *b);
+static void HpHead(struct HpHeadType *head, const unsigned char *cell);
+static void HpSetHead(unsigned char *cell, unsigned char sign, int len, int exp);
+static void HpLoad(unsigned short *win, const unsigned char *cell, int len, int start, int count);
+static void HpStore(unsigned char *cell, int start, const unsigned short *win, int count);
+static void HpCopy(unsigned char *dest, const unsigned char *src);
+static void HpSetInt(unsigned char *cell, unsigned long long value, int scale);
+static unsigned char HpCompMag(const unsigned char *a, const struct HpHeadType *ha, const unsigned char *b, const struct HpHeadType *hb);
+static void HpShiftDown(unsigned char *cell, int len, unsigned short top);
+static void HpShiftUp(unsigned char *cell, int len, int amount);
+static int HpLeadZeros(const unsigned char *cell, int len);
+static void HpSum(unsigned char *result, const unsigned char *a, const unsigned char *b, unsigned char negate);
+static void HpMulSmall(unsigned char *result, const unsigned char *a, unsigned int m);
+static void HpDivSmall(unsigned char *result, const unsigned char *a, unsigned int m);
+static void HpMult(unsigned char *result, const unsigned char *a, const unsigned char *b);
+static void HpBlocks(unsigned char *prod, const unsigned char *a, int a_len, int a_from, int a_to,
+                     const unsigned char *b, int b_len, int b_from, int b_to, int limit);
+static void HpKaratsuba(const unsigned char *a, int a_len, const unsigned char *b, int b_len, int h, int total);
+static unsigned char HpHalves(unsigned short *sum, const unsigned char *x, int x_len, int m);
+static void HpAccum(unsigned char *prod, int pos, int count);
+static int HpSteps(int *steps, int target);
+static unsigned long HpIsqrt(unsigned long long value);
+static void HpRecip(unsigned char *result, const unsigned char *d);
+static void HpDiv(unsigned char *result, const unsigned char *a, const unsigned char *b);
+static void HpRsqrt(unsigned char *result, const unsigned char *x);
+static void HpSqrt(unsigned char *result, const unsigned char *x);
+static void HpAgm(unsigned char *result, const unsigned char *a, const unsigned char *b);
+static int HpConstLimbs();
+static void HpConst(unsigned char *result, const unsigned char *cell);
+static void HpPi(unsigned char *result);
+static void HpLn2(unsigned char *result);
+static bool HpLn(unsigned char *result, const unsigned char *x);
+static void HpLnNear(unsigned char *result, const unsigned char *x, const unsigned char *d);
+static bool HpExp(unsigned char *result, const unsigned char *x);
+static void HpFromBCD(unsigned char *cell, const unsigned char *BCD);
+static bool HpToBCD(unsigned char *BCD, const unsigned char *cell, int places);
+static void HpRound(unsigned char *dest, const unsigned char *src, int digits);
 static unsigned char CompBCD(const char *num, unsigned char *var);
 static unsigned char CompBCD_RAM(const char *num, unsigned char *var);
-static unsigned char CompVarBCD(unsigned char *var1, unsigned char *var2);
-static unsigned char CompVarBCD_ItE(unsigned char *var1, unsigned char *var2);
-static unsigned char CompVarBCD_ItI(unsigned char *var1, unsigned char *var2);
+static unsigned char CompVarBCD_ItI(const unsigned char *var1, const unsigned char *var2);
 //static unsigned char TrigPrep(unsigned int stack_ptr_copy,unsigned char *cosine);
 static unsigned char TrigPrep(unsigned int stack_ptr_copy,int *cosine);
+static unsigned char CacheCheck(unsigned char *arg1, unsigned char *arg2);
+static bool CacheMatch(unsigned char *cell, unsigned char *var);
+static bool CacheLookup(unsigned char op, unsigned char *arg1, unsigned char *arg2, unsigned char *result, unsigned char *result2);
+static void CacheStore(unsigned char op, unsigned char *arg1, unsigned char *arg2, unsigned char *result, unsigned char *result2);
+static unsigned char RefineArgs(unsigned char key);
+static bool InputEditKey(int key);
+static void RefineStart(bool input, bool background);
+static bool IdleAbort();
+static unsigned char SpecIndex(unsigned char key);
+static unsigned char SpecNext();
+static void SpecStart(unsigned char index);
+static int LazyFind(int level);
+static int LazyNew(int level, unsigned char op);
+static void LazyForce(int slot);
+static void LazyForceAll();
+static bool LazyInverse(unsigned char op, unsigned char *cell);
+static bool LazyKey(int key);
 
 static int ProgLine(int prog, int line, int start, bool fill_buff);
 static void ProgLineFill(unsigned char *buffer);
 static void ProgLineFillCopy(unsigned char *buffer, const char *msg);
 
 static void DrawStack(bool menu, bool input, int stack_pointer);
+static int DrawSlot(int level, int low, int high);
+static void DrawFormat(char *text, int level);
+static void DrawDirty(int level);
 static void DrawInput(unsigned char *line, int input_ptr, int offset, bool menu);
+static void HpSheet();
+static unsigned char *HpPush();
+static bool HpDraw(const unsigned char *cell, int offset, int width);
 static void ErrorMsg(const char *msg);
 static void Number2(int num);
 
 static void delay_ms(int ms);
 
-#define ClrLCD() LCD_Byte(0xC)
-#define putchar(x) LCD_Byte(x)
+#define ClrLCD() LCD_Clear()
+#define putchar(x) LCD_Put(x)
 
 #pragma MM_OFFSET 0
 #pragma MM_GLOBALS
   //unsigned char p0[260]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, typing,    CompBCD
-  //unsigned char p1[260]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, DrawStack, CompBCD, CompVarBCD
+  //unsigned char p1[260]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, DrawStack
   //unsigned char p2[260]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD
   //unsigned char p3[260]; //PowBCD, AtanBCD, TrigPrep
   //unsigned char p4[260]; //PowBCD
   //unsigned char p5[260]; //AcosBCD, AsinBCD
   //unsigned char p6[260]; //AcosBCD, AsinBCD
   //unsigned char p7[260]; //AcosBCD, AsinBCD
-  //unsigned char buffer[260]; //AddBCD
   //unsigned char perm_buff1[260]; //DivBCD, MultBCD
   //unsigned char perm_buff2[260]; //DivBCD
   //unsigned char perm_buff3[260]; //DivBCD
   //unsigned char logs[MATH_LOG_TABLE*MATH_ENTRY_SIZE];
-  unsigned char logs[4218];
+  unsigned char logs[MATH_LOG_BYTES];
   //unsigned char trig[MATH_TRIG_TABLE*MATH_ENTRY_SIZE];
-  unsigned char trig[4218];
+  unsigned char trig[MATH_TRIG_BYTES];
+  //unsigned char hyper[MATH_HYP_TABLE*MATH_ENTRY_SIZE];
+  unsigned char hyper[MATH_HYP_BYTES];
   //unsigned char perm_zero[4];
   //unsigned char perm_K[36];
   //unsigned char perm_log10[36];
-  unsigned char BCD_stack[52000];
+  //unsigned char BCD_stack[STACK_SIZE*MATH_CELL_SIZE];
+  unsigned char BCD_stack[STACK_BYTES];
+  //unsigned char calc_cache[CACHE_SIZE*CACHE_ENTRY_SIZE];
+  unsigned char calc_cache[5824];
+  //unsigned char refine_cells[4*MATH_CELL_SIZE];
+  unsigned char refine_cells[480];
+  //unsigned char spec_cells[(SPEC_KEYS+1)*MATH_CELL_SIZE];
+  unsigned char spec_cells[720];
+  //unsigned char lazy_cells[LAZY_NODES*MATH_CELL_SIZE];
+  unsigned char lazy_cells[240];
+  //unsigned char hp_stack[HP_LEVELS*HP_CELL_SIZE];
+  unsigned char hp_stack[1040];
+  //unsigned char hp_temps[HP_TEMPS*HP_CELL_SIZE];
+  //T0-T1 HpRecip, HpRsqrt, HpSqrt, HpDiv, HpSheet
+  //T2-T5 HpAgm, T5-T9 HpPi, T10-T12 HpLn2, T10-T14 HpLn, T15-T16 HpExp,
+  //T17 HpSheet
+  unsigned char hp_temps[4680];
+  //unsigned char hp_prod[HP_HEADER+4*HP_LIMBS_MAX];
+  unsigned char hp_prod[516];
+  //HpKaratsuba product of the summed halves
+  //unsigned char hp_kmid[HP_HEADER+2*(HP_LIMBS_MAX/2+1)];
+  unsigned char hp_kmid[134];
+  unsigned char hp_one[6];
+  //pi and ln(2) are worked out the first time they're needed at more limbs
+  //than they have and kept here
+  //unsigned char hp_pi[HP_CELL_SIZE];
+  unsigned char hp_pi[260];
+  //unsigned char hp_ln2[HP_CELL_SIZE];
+  unsigned char hp_ln2[260];
   //unsigned char stack_buffer[260];
 #pragma MM_END
 
+//RAM_Start only sends 16 address bits so everything above has to fit in
+//bank 0 or it wraps onto logs
+#if (MATH_LOG_BYTES+MATH_TRIG_BYTES+MATH_HYP_BYTES+STACK_BYTES+ \
+     CACHE_SIZE*CACHE_ENTRY_SIZE+(4+SPEC_KEYS+1+LAZY_NODES)*MATH_CELL_SIZE+ \
+     (HP_LEVELS+HP_TEMPS+2)*HP_CELL_SIZE+HP_HEADER+4*HP_LIMBS_MAX+6+ \
+     HP_HEADER+HP_LIMBS_MAX+2)>65536
+#error "MM_GLOBALS don't fit in SRAM bank 0"
+#endif
+
 //Old variables moved from external to internal
 
 unsigned char p0[120]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, typing,    CompBCD
-unsigned char p1[120]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, DrawStack, CompBCD, CompVarBCD
+unsigned char p1[120]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD, DrawStack
 unsigned char p2[120]; //PowBCD, LnBCD, ExpBCD, TanBCD, AtanBCD
 unsigned char p3[120]; //PowBCD, AtanBCD, TrigPrep
 unsigned char p4[120]; //PowBCD
 unsigned char p5[120]; //AcosBCD, AsinBCD
 unsigned char p6[120]; //AcosBCD, AsinBCD
 unsigned char p7[120]; //AcosBCD, AsinBCD
-unsigned char buffer[120]; //AddBCD
-unsigned char perm_buff1[120]; //DivBCD, MultBCD, TanBCD, ExpBCD
-unsigned char perm_buff2[120]; //DivBCD, TanBCD, ImmedBCD
-unsigned char perm_buff3[120]; //DivBCD
+unsigned char perm_buff1[120]; //CalcTanBCD, ExpBCD, HypBCD
+unsigned char perm_buff2[120]; //TanBCD, ImmedBCD_RAM
 
 unsigned char perm_zero[4];
-unsigned char perm_K[36];
-unsigned char perm_log10[36];
+unsigned char perm_K[MATH_DIGITS+4];
+unsigned char perm_Kh[MATH_DIGITS+4];
+unsigned char perm_log10[MATH_DIGITS+4];
+unsigned char perm_deg[MATH_DIGITS+5]; //2 whole digits
 
 unsigned char stack_buffer[120];
 
+unsigned char hot_table[HOT_BYTES];
+unsigned short hot_offset[3][HOT_ENTRIES];
+unsigned char hot_count[3];
+unsigned char hot_len;
+
 //Local buffers for external memory
 unsigned char local_buff1[120];
 unsigned char local_buff2[120];
+unsigned char ext_buff[120]; //external wrappers, UnpackTable, HotPack, CacheMatch, typing
+
+//Windows the HP kernels move limbs through
+unsigned short hp_wa[HP_WINDOW]; //HpSum, HpMult, shifts
+unsigned short hp_wb[HP_WINDOW]; //HpSum, HpMult
+unsigned short hp_wp[2*HP_WINDOW]; //HpMult, HpAccum, HpCopy, HpFromBCD
+unsigned long hp_cols[2*HP_WINDOW]; //HpMult, HpKaratsuba
+unsigned short hp_ka[HP_LIMBS_MAX/4]; //HpKaratsuba
+unsigned short hp_kb[HP_LIMBS_MAX/4]; //HpKaratsuba
+int hp_prec; //limbs HP kernels keep
+int hp_pi_limbs,hp_ln2_limbs; //0 until worked out
+unsigned char hp_sp;
 
 struct SettingsType Settings;
+unsigned char table_places; //TablePlaces the tables are cut to. 0 for none
+unsigned int cache_next;
+unsigned int cache_hits, cache_lookups;
+bool refining, idle_abort, refine_pending, idle_stopped, idle_poll;
+unsigned char refine_key, refine_args, refine_hold_key;
+unsigned int refine_level;
+bool speculating, spec_failed;
+unsigned char spec_index;
+unsigned int stack_version;
+unsigned int spec_version[SPEC_KEYS];
+bool spec_ok[SPEC_KEYS];
+struct LazyType lazy[LAZY_NODES];
+unsigned char key_count[SPEC_KEYS];
 unsigned int stack_ptr[2];
 unsigned char which_stack;
 
+//Drawing goes into lcd_screen and LCD_Flush sends what differs from
+//lcd_shown, which is what the VFD has
+unsigned char lcd_screen[SCREEN_ROWS*SCREEN_WIDTH];
+unsigned char lcd_shown[SCREEN_ROWS*SCREEN_WIDTH];
+short lcd_x, lcd_y; //where putchar writes
+short lcd_hw_x, lcd_hw_y; //VFD cursor, -1 if not known
+short lcd_blink_x, lcd_blink_y;
+bool lcd_blink, lcd_blink_shown;
+//Bytes for the VFD. LCD_Byte adds at head and PIOINT0 takes from tail
+unsigned char lcd_queue[LCD_QUEUE];
+volatile unsigned char lcd_head, lcd_tail;
+struct DrawType draw_cache[SCREEN_ROWS];
+
 //PinGPIO LED1(P0_3,GPIO,OUTPUT);
 
 PinGPIO LCD_Busy(P0_4,GPIO,INPUT);
@@ -241,11 +572,21 @@ PinGPIO KeyOUT_D(P0_1,GPIO|PULLUP,OUTPUT);
 PinGPIO KeyOUT_E(P1_9,GPIO|PULLUP,OUTPUT);
 PinGPIO KeyOUT_F(P1_8,GPIO|PULLUP,OUTPUT);
 
+//PinGPIO writes GPIO1DATA back whole so PIOINT0 sending a byte in the middle
+//of one from the main code would lose its bits or the main code's. Port 1
+//pins written once PIOINT0 is on go through the masked data addresses, which
+//only change the bits in the address
+#define LCD_CLK_BIT   BIT0
+#define LCD_DATA_BIT  BIT1
+#define SPI_CS_BIT    BIT3
+#define KEY_OUT_F_BIT BIT8
+#define KEY_OUT_E_BIT BIT9
+#define GPIO1_Write(bit,value) (LPC_GPIO1->MASKED_ACCESS[(bit)]=(value)?(bit):0)
+
 int prog_which;
 
 //could store tables in flash if room left
 //what to do with extra external ram (3k?)
-//Make tables goes past 4218???
 //look at clock with logic analyzer
 
 int main(void)
@@ -264,8 +605,10 @@ int main(void)
 
   bool redraw=true, input=false;
   bool menu=false, redraw_input=false, do_input=false;
-  int input_ptr=0, input_offset=0;
+  int input_ptr=0, input_offset=0, input_save;
   int process_output=0;
+  int full_places;
+  bool quick;
   static const char StartInput[]="0123456789.";
 
   init();
@@ -288,29 +631,79 @@ int main(void)
 
   do
   {
-    if (redraw)
+    //nothing is drawn while a program runs so results can stay as nodes
+    if ((redraw)&&(!prog_running))
     {
       ClrLCD();
       DrawStack(menu,input,stack_ptr[which_stack]);
       redraw=false;
     }
-    if (redraw_input)
+    if ((redraw_input)&&(!prog_running))
     {
       DrawInput(p0,input_ptr,input_offset,menu);
       redraw_input=false;
     }
+    //on screen before refining or speculating starts
+    LCD_Flush();
 
-    if (prog_running)
+    if (refine_hold_key)
     {
-      which_stack=1;
-      key=RAM_Read((unsigned char *)(prog_which*PROG_TOTAL+PROG_HEADER+prog_counter));
-      which_stack=0;
-      if (!key) prog_running=false;
-      prog_counter++;
+      //key that arrived before refining finished
+      key=refine_hold_key;
+      refine_hold_key=0;
     }
-    if (!prog_running)
+    else
     {
-      key=GetKey();
+      if (prog_running)
+      {
+        which_stack=1;
+        key=RAM_Read((unsigned char *)(prog_which*PROG_TOTAL+PROG_HEADER+prog_counter));
+        which_stack=0;
+        if (!key)
+        {
+          //results were left undrawn while it ran
+          prog_running=false;
+          if (input)
+          {
+            //p0 holds the number being typed and the kernels use it
+            RAM_WriteBlock(BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE,p0,MATH_CELL_SIZE);
+            LazyForceAll();
+            RAM_ReadBlock(p0,BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE,MATH_CELL_SIZE);
+          }
+          else LazyForceAll();
+          ClrLCD();
+          DrawStack(menu,input,stack_ptr[which_stack]);
+          if (input) DrawInput(p0,input_ptr,input_offset,menu);
+          redraw=false;
+          redraw_input=false;
+        }
+        prog_counter++;
+      }
+      if (!prog_running)
+      {
+        if ((refine_pending)&&(!input)&&(!idle_stopped))
+        {
+          //refine quick result until a key is pressed
+          key=refine_key;
+          RefineStart(false,true);
+        }
+        else
+        {
+          i=SPEC_KEYS;
+          if ((!input)&&(!idle_stopped)) i=SpecNext();
+          if (i<SPEC_KEYS)
+          {
+            //work out a likely next key while waiting for one
+            key=SpecKeys[i];
+            SpecStart(i);
+          }
+          else
+          {
+            key=GetKey();
+            idle_stopped=false;
+          }
+        }
+      }
     }
 
     j=0;
@@ -323,6 +716,23 @@ int main(void)
       }
     }while(StartInput[j++]);
 
+    if ((refine_pending)&&(!refining))
+    {
+      if ((!input)&&((key==KEY_CLEAR)||(key==KEY_BACKSPACE)||(key==KEY_DELETE)))
+      {
+        //quick result is being thrown away
+        refine_pending=false;
+      }
+      else if ((j!=0)&&((!input)||(!InputEditKey(key))))
+      {
+        //anything that can use the quick result waits for full precision
+        //typing a number or editing it can go ahead
+        refine_hold_key=key;
+        key=refine_key;
+        RefineStart(input,false);
+      }
+    }
+
     if (j==0)//numbers
     {
       if (input==false)
@@ -335,8 +745,11 @@ int main(void)
         else
         {
           input=true;
-          ClrLCD();
-          DrawStack(menu,input,stack_ptr[which_stack]);
+          if (!prog_running)
+          {
+            ClrLCD();
+            DrawStack(menu,input,stack_ptr[which_stack]);
+          }
           input_offset=0;
           input_ptr=1;
           p0[0]=key;
@@ -372,7 +785,7 @@ int main(void)
     }
     else//not numbers
     {
-      if (input)
+      if ((input)&&(!refining))
       {
         switch(key)
         {
@@ -482,17 +895,69 @@ int main(void)
         else
         {
           SetBlink(false);
-          BufferBCD_ItE(p0,BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE);
-
-          if (IsZero(BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE)&&(BCD_stack[stack_ptr[which_stack]*MATH_CELL_SIZE+BCD_SIGN])) BCD_stack[stack_ptr[which_stack]*MATH_CELL_SIZE+BCD_SIGN]=0;
-          FullShrinkBCD(BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE);
+          BufferBCD_ItI(p0,ext_buff);
+          CommitBCD(BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE,ext_buff);
           stack_ptr[which_stack]++;
+          stack_version++;
           input=false;
         }
         redraw=true;
         do_input=false;
       }
+      if ((!refining)&&(!speculating))
+      {
+        i=SpecIndex(key);
+        if (i<SPEC_KEYS)
+        {
+          if (!prog_running)
+          {
+            key_count[i]++;
+            //halve so recent keys count for more
+            if (key_count[i]==255) for (j=0;j<SPEC_KEYS;j++) key_count[j]>>=1;
+          }
+          if ((spec_version[i]==stack_version)&&(spec_ok[i])&&(stack_ptr[which_stack]>=1))
+          {
+            //already worked out while idle
+            CopyBCD(BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,spec_cells+i*MATH_CELL_SIZE);
+            redraw=true;
+            key=0;
+          }
+        }
+      }
+
+      //quick result at QUICK_PLACES first. refined later
+      quick=false;
+      if ((!refining)&&(!speculating)&&(!prog_running)&&(Settings.DecPlaces>QUICK_PLACES))
+      {
+        refine_args=RefineArgs(key);
+        if ((refine_args)&&(stack_ptr[which_stack]>=refine_args))
+        {
+          for (j=0;j<refine_args;j++) CopyBCD(refine_cells+j*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-refine_args+j)*MATH_CELL_SIZE);
+          full_places=Settings.DecPlaces;
+          Settings.DecPlaces=QUICK_PLACES;
+          SetDecPlaces();
+          quick=true;
+        }
+      }
+      //only changes after a quick key or a new DecPlaces. Quick keys in a row
+      //before refining starts keep the quick tables
+      SetTables();
+
       process_output=0;
+      //edit keys leave key at 0 and have nothing to force
+      if ((prog_running)&&(key))
+      {
+        //p0 still holds the number being typed if it was bad and the kernels
+        //use it. LazyKey only ever pops so the cell above the top stays free
+        input_save=stack_ptr[which_stack];
+        if (input) RAM_WriteBlock(BCD_stack+input_save*MATH_CELL_SIZE,p0,MATH_CELL_SIZE);
+        if (LazyKey(key))
+        {
+          stack_version++;
+          key=0;
+        }
+        if (input) RAM_ReadBlock(p0,BCD_stack+input_save*MATH_CELL_SIZE,MATH_CELL_SIZE);
+      }
       switch (key)
       {
         case '+':
@@ -501,7 +966,7 @@ int main(void)
             CopyBCD_EtI(p0,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE);
             CopyBCD_EtI(p1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
             //AddBCD(stack_buffer,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            AddBCD(stack_buffer,p0,p1);
+            if (!ShortMathBCD('+',stack_buffer,p0,p1)) AddBCD(stack_buffer,p0,p1);
             process_output=2;
             redraw=true;
           }
@@ -512,7 +977,7 @@ int main(void)
             CopyBCD_EtI(p0,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE);
             CopyBCD_EtI(p1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
             //SubBCD(stack_buffer,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            SubBCD(stack_buffer,p0,p1);
+            if (!ShortMathBCD('-',stack_buffer,p0,p1)) SubBCD(stack_buffer,p0,p1);
             process_output=2;
             redraw=true;
           }
@@ -529,7 +994,7 @@ int main(void)
               CopyBCD_EtI(p0,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE);
               CopyBCD_EtI(p1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
               //DivBCD(stack_buffer,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-              DivBCD(stack_buffer,p0,p1);
+              if (!ShortDivBCD(stack_buffer,p0,p1)) DivBCD(stack_buffer,p0,p1);
               process_output=2;
             }
             redraw=true;
@@ -552,16 +1017,8 @@ int main(void)
               p3[BCD_SIGN]=0;
               p2[BCD_SIGN]=0;
 
-              while(1)
-              {
-                SubBCD(p0,p3,p2);
-                if (p0[BCD_SIGN])
-                {
-                  CopyBCD_ItI(stack_buffer,p3);
-                  break;
-                }
-                else CopyBCD_ItI(p3,p0);
-              }
+              while(CompVarBCD_ItI(p3,p2)!=COMP_LT) SubBCD(p3,p3,p2);
+              CopyBCD_ItI(stack_buffer,p3);
               stack_buffer[BCD_SIGN]=j;
               process_output=2;
             }
@@ -574,7 +1031,7 @@ int main(void)
             CopyBCD_EtI(p0,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE);
             CopyBCD_EtI(p1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
             //MultBCD(stack_buffer,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            MultBCD(stack_buffer,p0,p1);
+            if (!ShortMathBCD('*',stack_buffer,p0,p1)) MultBCD(stack_buffer,p0,p1);
             process_output=2;
             redraw=true;
           }
@@ -688,7 +1145,7 @@ int main(void)
           {
             BCD_stack[(stack_ptr[which_stack]-1)*MATH_CELL_SIZE+BCD_SIGN]=0;
             TrigPrep(stack_ptr[which_stack],&j);
-            if (IsZero_RAM(p3)) ImmedBCD("1",stack_buffer);
+            if (IsZero_RAM(p3)) ImmedBCD_RAM("1",stack_buffer);
             else TanBCD(p4,stack_buffer,p3);
             if (j==1) stack_buffer[BCD_SIGN]=1;
             process_output=1;
@@ -699,9 +1156,10 @@ int main(void)
           if (stack_ptr[which_stack]>=1)
           {
             process_output=1;
-            i=CompBCD("0",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            j=CompBCD("1",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            k=CompBCD("-1",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            i=CompBCD_RAM("0",local_buff1);
+            j=CompBCD_RAM("1",local_buff1);
+            k=CompBCD_RAM("-1",local_buff1);
             if (i==COMP_EQ) ImmedBCD_RAM("90",stack_buffer);
             else if (j==COMP_EQ) ImmedBCD_RAM("0",stack_buffer);
             else if (k==COMP_EQ) ImmedBCD_RAM("180",stack_buffer);
@@ -710,21 +1168,14 @@ int main(void)
               ErrorMsg("Invalid input");
               process_output=0;
             }
-            else
-            {
-              CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-              AcosBCD(stack_buffer,local_buff1);
-            }
+            else AcosBCD(stack_buffer,local_buff1);
             redraw=true;
           }
           break;
         case KEY_EX:
           if (stack_ptr[which_stack]>=1)
           {
-            ImmedBCD_RAM("177",p0);
-            CopyBCD_EtI(p1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            SubBCD(p2,p1,p0);
-            if (p2[BCD_SIGN]==0)
+            if (CompBCD("177",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE)!=COMP_GT)
             {
               ErrorMsg("Argument\ntoo large");
             }
@@ -756,15 +1207,11 @@ int main(void)
               CopyBCD_EtI(p2,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
               CopyBCD_ItI(p1,p2);
               p2[BCD_LEN]=p2[BCD_DEC];
-              SubBCD(p0,p1,p2);
 
-              //if (CompVarBCD(p2,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE)==COMP_EQ)//x is an integer
-              if (IsZero_RAM(p0))//x is an integer
+              if (CompVarBCD_ItI(p1,p2)==COMP_EQ)//x is an integer
               {
                 ImmedBCD_RAM("117",p2);
-                SubBCD(p0,p1,p2);
-                //if (CompVarBCD(BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,p2)==COMP_GT)
-                if (p0[BCD_SIGN]==0)
+                if (CompVarBCD_ItI(p1,p2)!=COMP_LT)
                 {
                   i=255;
                 }
@@ -800,11 +1247,6 @@ int main(void)
                 ImmedBCD_RAM("10",p5);
                 CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
                 PowBCD(stack_buffer,p5,local_buff1);
-                if (stack_buffer[BCD_DEC]>(Settings.DecPlaces)) stack_buffer[BCD_LEN]=stack_buffer[BCD_DEC];
-                else if (stack_buffer[BCD_LEN]>(Settings.DecPlaces))
-                {
-                  stack_buffer[BCD_LEN]=Settings.DecPlaces;
-                }
               }
 
               if ((j)&&(x==0))
@@ -839,7 +1281,7 @@ int main(void)
                 {
                   k=RAM_Read((unsigned char *)(PROG_TOTAL*i+j));
                   if (!k) break;
-                  if (k>=0x20) LCD_Byte(k);
+                  if (k>=0x20) putchar(k);
                 }
                 //j=RAM_Read((unsigned char *)(PROG_TOTAL*i+0));
                 //j+=(RAM_Read((unsigned char *)(PROG_TOTAL*i+1))<<8);
@@ -849,13 +1291,13 @@ int main(void)
                 for (j=0;RAM_Read((unsigned char *)(i*PROG_TOTAL+PROG_HEADER+j));j++);
                 gotoxy(SCREEN_WIDTH-4,i-y);
                 j=j%0x1000; //Max program size is 2^12
-                LCD_Byte('0'+j/1000);
+                putchar('0'+j/1000);
                 j=j%1000;
-                LCD_Byte('0'+j/100);
+                putchar('0'+j/100);
                 j=j%100;
-                LCD_Byte('0'+j/10);
+                putchar('0'+j/10);
                 j=j%10;
-                LCD_Byte('0'+j);
+                putchar('0'+j);
               }
               which_stack=0;
 
@@ -922,7 +1364,7 @@ int main(void)
                   {
                     if (!p0[j]) prog_title_done=true;
                     if (prog_title_done) LCD_Text(" ");
-                    else (LCD_Byte(p0[j]));
+                    else (putchar(p0[j]));
                   }
                   gotoxy(prog_edit_pos+4,(x-y));
                 }
@@ -1012,6 +1454,12 @@ int main(void)
                          (key==KEY_TAN)||
                          (key==KEY_ATAN)||
                          (key==KEY_X2)||
+                         (key==KEY_SINH)||
+                         (key==KEY_COSH)||
+                         (key==KEY_TANH)||
+                         (key==KEY_ASINH)||
+                         (key==KEY_ACOSH)||
+                         (key==KEY_ATANH)||
                          (key==KEY_SIGN))
 
                 {
@@ -1050,13 +1498,13 @@ int main(void)
                       for (l=0;l<(SCREEN_WIDTH-4);l++)
                       {
                         if (p1[l]==0) prog_edit_done=true;
-                        if (prog_edit_done) LCD_Byte(' ');
-                        else if (p1[l]!=KEY_INS) LCD_Byte(p1[l]);
+                        if (prog_edit_done) putchar(' ');
+                        else if (p1[l]!=KEY_INS) putchar(p1[l]);
                       }
                       if (prog_edit_done==false)
                       {
                         gotoxy(SCREEN_WIDTH-1,j-k);
-                        LCD_Byte('>');
+                        putchar('>');
                       }
                       SetBlink(true);
 
@@ -1099,13 +1547,13 @@ int main(void)
                       for (l=0;l<(SCREEN_WIDTH-4);l++)
                       {
                         if (p1[l]==0) prog_edit_done=true;
-                        if (prog_edit_done) LCD_Byte(' ');
-                        else if (p1[l]!=KEY_INS) LCD_Byte(p1[l]);
+                        if (prog_edit_done) putchar(' ');
+                        else if (p1[l]!=KEY_INS) putchar(p1[l]);
                       }
                       if (prog_edit_done==false)
                       {
                         gotoxy(SCREEN_WIDTH-1,j-k);
-                        LCD_Byte('>');
+                        putchar('>');
                       }
                       SetBlink(true);
 
@@ -1249,13 +1697,13 @@ int main(void)
                     for (l=0;l<(SCREEN_WIDTH-4);l++)
                     {
                       if (p1[l]==0) prog_edit_done=true;
-                      if (prog_edit_done) LCD_Byte(' ');
-                      else if (p1[l]!=KEY_INS) LCD_Byte(p1[l]);
+                      if (prog_edit_done) putchar(' ');
+                      else if (p1[l]!=KEY_INS) putchar(p1[l]);
                     }
                     if (prog_edit_done==false)
                     {
                       gotoxy(SCREEN_WIDTH-1,i-k);
-                      LCD_Byte('>');
+                      putchar('>');
                     }
                   }
                   redraw=false;
@@ -1295,8 +1743,8 @@ int main(void)
                       if (p1[i]!=KEY_INS)
                       {
                         if (p1[i]==0) prog_edit_done=true;
-                        if (prog_edit_done) LCD_Byte(' ');
-                        else LCD_Byte(p1[i]);
+                        if (prog_edit_done) putchar(' ');
+                        else putchar(p1[i]);
                       }
                       else extra_spaces++;
                     }
@@ -1306,15 +1754,15 @@ int main(void)
                   {
                     //1 for <?
                     m=m-(SCREEN_WIDTH-4)+1;
-                    LCD_Byte('<');
+                    putchar('<');
                     //4 characters for address and colon
                     for (i=1;i<(SCREEN_WIDTH-4);i++)
                     {
                       if (p1[i+m]!=KEY_INS)
                       {
                         if (p1[i+m]==0) prog_edit_done=true;
-                        if (prog_edit_done) LCD_Byte(' ');
-                        else  LCD_Byte(p1[i+m]);
+                        if (prog_edit_done) putchar(' ');
+                        else  putchar(p1[i+m]);
                       }
                       else extra_spaces++;
                     }
@@ -1561,14 +2009,6 @@ int main(void)
                 {
                   CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-2)*MATH_CELL_SIZE);
                   PowBCD(stack_buffer,local_buff1,p5);
-                  if (stack_buffer[BCD_DEC]>(Settings.DecPlaces))
-                  {
-                    stack_buffer[BCD_LEN]=stack_buffer[BCD_DEC];
-                  }
-                  else if (stack_buffer[BCD_LEN]>(Settings.DecPlaces))
-                  {
-                    stack_buffer[BCD_LEN]=Settings.DecPlaces;
-                  }
 
                   if ((j==3)&&(true)) //both are integers
                   {
@@ -1616,11 +2056,6 @@ int main(void)
               CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
               //PowBCD(stack_buffer,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,p5);
               PowBCD(stack_buffer,local_buff1,p5);
-              if (stack_buffer[BCD_DEC]>(Settings.DecPlaces)) stack_buffer[BCD_LEN]=stack_buffer[BCD_DEC];
-              else if (stack_buffer[BCD_LEN]>(Settings.DecPlaces))
-              {
-                stack_buffer[BCD_LEN]=Settings.DecPlaces;
-              }
               process_output=1;
             }
             redraw=true;
@@ -1664,9 +2099,10 @@ int main(void)
           if (stack_ptr[which_stack]>=1)
           {
             process_output=1;
-            i=CompBCD("0",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            j=CompBCD("1",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            k=CompBCD("-1",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            i=CompBCD_RAM("0",local_buff1);
+            j=CompBCD_RAM("1",local_buff1);
+            k=CompBCD_RAM("-1",local_buff1);
             if (i==COMP_EQ) ImmedBCD_RAM("0",stack_buffer);
             else if (j==COMP_EQ) ImmedBCD_RAM("90",stack_buffer);
             else if (k==COMP_EQ) ImmedBCD_RAM("-90",stack_buffer);
@@ -1675,23 +2111,100 @@ int main(void)
               ErrorMsg("Invalid input");
               process_output=0;
             }
+            else AsinBCD(stack_buffer,local_buff1);
+            redraw=true;
+          }
+          break;
+        case KEY_ATAN:
+          if (stack_ptr[which_stack]>=1)
+          {
+            CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            AtanBCD(stack_buffer,local_buff1);
+            process_output=1;
+            redraw=true;
+          }
+          break;
+        case KEY_SINH:
+        case KEY_COSH:
+        case KEY_TANH:
+          if (stack_ptr[which_stack]>=1)
+          {
+            CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            j=local_buff1[BCD_SIGN];
+            local_buff1[BCD_SIGN]=0;
+            i=CompBCD_RAM("177",local_buff1);
+            local_buff1[BCD_SIGN]=j;
+            if ((i!=COMP_GT)&&(key==KEY_TANH))
+            {
+              ImmedBCD_RAM("1",stack_buffer);
+              stack_buffer[BCD_SIGN]=j;
+              process_output=1;
+            }
+            else if (i!=COMP_GT)
+            {
+              ErrorMsg("Argument\ntoo large");
+            }
             else
             {
-              CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-              AsinBCD(stack_buffer,local_buff1);
+              HypBCD(stack_buffer,p4,local_buff1);
+              if (key==KEY_COSH) CopyBCD_ItI(stack_buffer,p4);
+              else if (key==KEY_TANH)
+              {
+                DivBCD(p3,stack_buffer,p4);
+                CopyBCD_ItI(stack_buffer,p3);
+              }
+              process_output=1;
             }
             redraw=true;
           }
           break;
-        case KEY_ATAN:
+        case KEY_ASINH:
           if (stack_ptr[which_stack]>=1)
           {
             CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            AtanBCD(stack_buffer,local_buff1);
+            AsinhBCD(stack_buffer,local_buff1);
             process_output=1;
             redraw=true;
           }
           break;
+        case KEY_ACOSH:
+          if (stack_ptr[which_stack]>=1)
+          {
+            if (CompBCD("1",BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE)==COMP_GT)
+            {
+              ErrorMsg("Invalid input");
+            }
+            else
+            {
+              CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+              AcoshBCD(stack_buffer,local_buff1);
+              process_output=1;
+            }
+            redraw=true;
+          }
+          break;
+        case KEY_ATANH:
+          if (stack_ptr[which_stack]>=1)
+          {
+            CopyBCD_EtI(local_buff1,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+            local_buff1[BCD_SIGN]=0;
+            if (CompBCD_RAM("1",local_buff1)!=COMP_GT)
+            {
+              ErrorMsg("Invalid input");
+            }
+            else
+            {
+              local_buff1[BCD_SIGN]=BCD_stack[(stack_ptr[which_stack]-1)*MATH_CELL_SIZE+BCD_SIGN];
+              AtanhBCD(stack_buffer,local_buff1);
+              process_output=1;
+            }
+            redraw=true;
+          }
+          break;
+        case KEY_HIPREC:
+          if (!prog_running) HpSheet();
+          redraw=true;
+          break;
         case KEY_SETTINGS:
           ClrLCD();
           gotoxy(0,0);
@@ -1702,6 +2215,14 @@ int main(void)
           LCD_Text("Sci. Not.");
           //gotoxy(1,3);
           //LCD_Text("Battery:");
+          gotoxy(1,3);
+          LCD_Text("Cache hits:");
+          gotoxy(SCREEN_WIDTH-4,3);
+          k=0;
+          if (cache_lookups) k=(cache_hits*100)/cache_lookups;
+          if (k>99) k=99;
+          Number2(k);
+          putchar('%');
 
           i=Settings.DecPlaces;
           j=39;
@@ -1754,7 +2275,7 @@ int main(void)
             {
               if (y==0)
               {
-                if (Settings.DecPlaces<32)
+                if (Settings.DecPlaces<(MATH_DIGITS-GUARD_DIGITS))
                 {
                   Settings.DecPlaces++;
                   x=1;
@@ -1826,8 +2347,7 @@ int main(void)
           if (stack_ptr[which_stack]>=1)
           {
             CopyBCD_EtI(p0,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
-            CopyBCD_ItI(local_buff1,p0);
-            MultBCD(stack_buffer,p0,local_buff1);
+            if (!ShortMathBCD('*',stack_buffer,p0,p0)) SquareBCD(stack_buffer,p0);
             process_output=1;
             redraw=true;
           }
@@ -1849,9 +2369,8 @@ int main(void)
         {
           if (process_output>0)
           {
-            CopyBCD(p0,stack_buffer);
-            ImmedBCD(deg_factor,p1);
-            DivBCD(stack_buffer,p0,p1);
+            CopyBCD_ItI(p0,stack_buffer);
+            DivBCD(stack_buffer,p0,perm_deg);
           }
         }
       }
@@ -1859,9 +2378,61 @@ int main(void)
       if (process_output==2) stack_ptr[which_stack]--;
       if (process_output>0)
       {
-        FullShrinkBCD_RAM(stack_buffer);
-        if (IsZero_RAM(stack_buffer)&&(stack_buffer[BCD_SIGN])) stack_buffer[BCD_SIGN]=0;
-        CopyBCD_ItE(BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,stack_buffer);
+        RoundBCD(stack_buffer,Settings.DecPlaces);
+        CommitBCD(BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,stack_buffer);
+      }
+      //keys that change X in place don't all go through CommitBCD
+      DrawDirty(stack_ptr[which_stack]-1);
+
+      if (!speculating) stack_version++;
+
+      if (quick)
+      {
+        Settings.DecPlaces=full_places;
+        SetDecPlaces();
+        if (process_output>0)
+        {
+          refine_pending=true;
+          refine_key=key;
+          refine_level=stack_ptr[which_stack]-1;
+          CopyBCD(refine_cells+REFINE_QUICK,BCD_stack+refine_level*MATH_CELL_SIZE);
+        }
+      }
+      else if (refining)
+      {
+        if (idle_abort)
+        {
+          //key pressed. put quick result back and try again later
+          stack_ptr[which_stack]=refine_level+1;
+          CopyBCD(BCD_stack+refine_level*MATH_CELL_SIZE,refine_cells+REFINE_QUICK);
+          idle_stopped=true;
+          redraw=false;
+        }
+        else refine_pending=false;
+        if (input)
+        {
+          for (j=0;j<MATH_CELL_SIZE;j++) p0[j]=refine_cells[REFINE_INPUT+j];
+          redraw_input=true;
+        }
+        refining=false;
+        idle_abort=false;
+        idle_poll=false;
+      }
+      else if (speculating)
+      {
+        if (idle_abort) idle_stopped=true;
+        else
+        {
+          //done for this stack even if it failed
+          spec_version[spec_index]=stack_version;
+          spec_ok[spec_index]=(process_output>0)&&(!spec_failed);
+          if (spec_ok[spec_index]) CopyBCD(spec_cells+spec_index*MATH_CELL_SIZE,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+        }
+        CopyBCD(BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE,spec_cells+SPEC_X);
+        redraw=false;
+        speculating=false;
+        idle_abort=false;
+        idle_poll=false;
       }
     }
   //} while (key!=KEY_ESCAPE);
@@ -1874,27 +2445,62 @@ static void Calc_Init()
 {
   int i;
   Settings.DecPlaces=24;
+  if (Settings.DecPlaces>(MATH_DIGITS-GUARD_DIGITS)) Settings.DecPlaces=MATH_DIGITS-GUARD_DIGITS;
   Settings.DegRad=true;
   Settings.LogTableSize=MATH_LOG_TABLE;
   Settings.TrigTableSize=MATH_TRIG_TABLE;
+  Settings.HypTableSize=MATH_HYP_TABLE;
+  Settings.HpDigits=HP_DIGITS_MIN;
+  Settings.HpLimbs=Settings.HpDigits/LIMB_DIGITS+HP_GUARD_LIMBS;
 
   stack_ptr[0]=0;
   stack_ptr[1]=0;
   which_stack=0;
 
+  for (i=0;i<CACHE_SIZE;i++) calc_cache[i*CACHE_ENTRY_SIZE]=0;
+  cache_next=0;
+  cache_hits=0;
+  cache_lookups=0;
+
+  refining=false;
+  idle_abort=false;
+  refine_pending=false;
+  idle_stopped=false;
+  idle_poll=false;
+  refine_hold_key=0;
+
+  speculating=false;
+  stack_version=1;
+  DrawDirty(0);
+  for (i=0;i<SPEC_KEYS;i++)
+  {
+    spec_version[i]=0;
+    key_count[i]=0;
+  }
+
   LCD_Text("Writing RAM..");
+  LCD_Flush();
   ImmedBCD_RAM("0",perm_zero);
   ImmedBCD_RAM(K,perm_K);
+  ImmedBCD_RAM(K_hyp,perm_Kh);
   ImmedBCD_RAM(log10_factor,perm_log10);
+  ImmedBCD_RAM(deg_factor,perm_deg);
   LCD_Text("Done\r\n");
 
   LCD_Text("Writing RAM0..");
+  LCD_Flush();
   MakeTables();
   SetDecPlaces();
+  table_places=0;
+  SetTables();
+  HpSetInt(hp_one,1,0);
+  hp_pi_limbs=0;
+  hp_ln2_limbs=0;
   LCD_Text("Done\r\n");
 
   //Use second page for programs
   LCD_Text("Writing RAM1..");
+  LCD_Flush();
   which_stack=1;
   for (i=0;i<PROG_COUNT*PROG_TOTAL;i++)
   {
@@ -1917,6 +2523,7 @@ static void Calc_Init()
   RAM_Write((const unsigned char*)(2*PROG_TOTAL+PROG_HEADER+7),'+');
   which_stack=0;
   LCD_Text("Done");
+  LCD_Flush();
   //delay_ms(500);
 
   /*
@@ -1933,46 +2540,199 @@ static void Calc_Init()
   for (i=0;i<64;i++) LCD_Byte(CustomChars[i],1);*/
 }
 
+//Queues a byte for the VFD. PIOINT0 sends the rest each time the VFD goes
+//ready so drawing only waits here when the queue is full
 static void LCD_Byte(unsigned char data)
+{
+  unsigned char next=(lcd_head+1)&(LCD_QUEUE-1);
+
+  while (next==lcd_tail) LCD_Next();
+  lcd_queue[lcd_head]=data;
+  lcd_head=next;
+  LCD_Next();
+}
+
+//Sends the oldest queued byte if the VFD is ready. Called from PIOINT0, from
+//LCD_Byte in case the queue was idle and while polling keys in case an edge
+//was missed
+static void LCD_Next()
+{
+  __disable_irq();
+  if ((lcd_tail!=lcd_head)&&(!LCD_Busy.read()))
+  {
+    //only edges from this byte count
+    LPC_GPIO0->IC=BIT4;
+    LCD_Send(lcd_queue[lcd_tail]);
+    lcd_tail=(lcd_tail+1)&(LCD_QUEUE-1);
+  }
+  __enable_irq();
+}
+
+//Busy fell so the VFD is ready for another byte
+extern "C" void PIOINT0_IRQHandler()
+{
+  LPC_GPIO0->IC=BIT4;
+  LCD_Next();
+}
+
+static void LCD_Send(unsigned char data)
 {
   int i;
+
   //LED1=1;
   for (i=0;i<8;i++)
   {
-    LCD_Clk=0;
+    GPIO1_Write(LCD_CLK_BIT,0);
     //delay_ms(1);
-    if (data&(1<<i)) LCD_Data=1;
-    else LCD_Data=0;
+    GPIO1_Write(LCD_DATA_BIT,data&(1<<i));
     //delay_ms(1);
-    LCD_Clk=1;
+    GPIO1_Write(LCD_CLK_BIT,1);
     //delay_ms(1);
   }
-  while (LCD_Busy.read());
   //LED1=0;
 }
 
 static void LCD_Text(const char *data)
 {
   unsigned long i;
-  for (i=0;data[i];i++) LCD_Byte(data[i]);
+  for (i=0;data[i];i++) putchar(data[i]);
 }
 
 static void LCD_Hex(unsigned char value)
 {
-  if ((value>>4)>9) LCD_Byte((value>>4)-10+'A');
-  else LCD_Byte((value>>4)+'0');
-  if ((value&0xF)>9) LCD_Byte((value&0xF)-10+'A');
-  else LCD_Byte((value&0xF)+'0');
+  if ((value>>4)>9) putchar((value>>4)-10+'A');
+  else putchar((value>>4)+'0');
+  if ((value&0xF)>9) putchar((value&0xF)-10+'A');
+  else putchar((value&0xF)+'0');
 }
 
 static void LCD_Hex8(unsigned char value)
 {
-  if ((value&0xF)>9) LCD_Byte((value&0xF)-10+'A');
-  else LCD_Byte((value&0xF)+'0');
+  if ((value&0xF)>9) putchar((value&0xF)-10+'A');
+  else putchar((value&0xF)+'0');
+}
+
+//Writes to the shadow screen and moves on like the VFD does
+static void LCD_Put(unsigned char data)
+{
+  if (data=='\r') lcd_x=0;
+  else if (data=='\n') lcd_y++;
+  else
+  {
+    if ((lcd_x>=0)&&(lcd_x<SCREEN_WIDTH)&&(lcd_y>=0)&&(lcd_y<SCREEN_ROWS))
+    {
+      lcd_screen[lcd_y*SCREEN_WIDTH+lcd_x]=data;
+    }
+    lcd_x++;
+    if (lcd_x==SCREEN_WIDTH)
+    {
+      lcd_x=0;
+      lcd_y++;
+    }
+  }
+}
+
+static void LCD_Clear()
+{
+  int i;
+
+  for (i=0;i<SCREEN_ROWS*SCREEN_WIDTH;i++) lcd_screen[i]=' ';
+  lcd_x=0;
+  lcd_y=0;
+}
+
+//Sends the characters that changed since the last flush. Each run gets one
+//gotoxy and short unchanged gaps inside a run are sent again instead of
+//starting a new one. Blink is off while writing other rows then put back at
+//its place
+static void LCD_Flush()
+{
+  int i,j,end,row;
+
+  for (row=0;row<SCREEN_ROWS;row++)
+  {
+    i=row*SCREEN_WIDTH;
+    while (i<(row+1)*SCREEN_WIDTH)
+    {
+      if (lcd_screen[i]==lcd_shown[i])
+      {
+        i++;
+        continue;
+      }
+      end=i;
+      for (j=i+1;(j<(row+1)*SCREEN_WIDTH)&&(j-end<=LCD_GAP);j++)
+      {
+        if (lcd_screen[j]!=lcd_shown[j]) end=j;
+      }
+
+      //the cursor moving along its own row while it's written is fine
+      if ((lcd_blink_shown)&&((!lcd_blink)||(row!=lcd_blink_y))) LCD_Blink(false);
+      if ((lcd_hw_x!=i-row*SCREEN_WIDTH)||(lcd_hw_y!=row)) LCD_Cursor(i-row*SCREEN_WIDTH,row);
+      for (;i<=end;i++)
+      {
+        LCD_Byte(lcd_screen[i]);
+        lcd_shown[i]=lcd_screen[i];
+      }
+      lcd_hw_x=i-row*SCREEN_WIDTH;
+      //wrapping at the end of a line isn't counted on
+      if (lcd_hw_x==SCREEN_WIDTH) lcd_hw_x=-1;
+    }
+  }
+
+  if (lcd_blink)
+  {
+    if ((lcd_hw_x!=lcd_blink_x)||(lcd_hw_y!=lcd_blink_y)) LCD_Cursor(lcd_blink_x,lcd_blink_y);
+    if (!lcd_blink_shown) LCD_Blink(true);
+  }
+  else if (lcd_blink_shown) LCD_Blink(false);
+}
+
+//Moves the VFD cursor. Short moves along the row it's on are sent as CR,
+//BS or HT instead of the 6 byte gotoxy
+static void LCD_Cursor(short x, short y)
+{
+  if ((lcd_hw_y==y)&&(lcd_hw_x>=0))
+  {
+    if ((x<lcd_hw_x)&&(x+1<lcd_hw_x-x)&&(x<LCD_STEPS))
+    {
+      LCD_Byte('\r');
+      lcd_hw_x=0;
+    }
+    if ((x>=lcd_hw_x)&&(x-lcd_hw_x<=LCD_STEPS))
+    {
+      for (;lcd_hw_x<x;lcd_hw_x++) LCD_Byte(0x09);
+      return;
+    }
+    if ((x<lcd_hw_x)&&(lcd_hw_x-x<=LCD_STEPS))
+    {
+      for (;lcd_hw_x>x;lcd_hw_x--) LCD_Byte(0x08);
+      return;
+    }
+  }
+
+  LCD_Byte(0x1F);
+  LCD_Byte(0x24);
+  LCD_Byte(x*7);
+  LCD_Byte(0);
+  LCD_Byte(y);
+  LCD_Byte(0);
+  lcd_hw_x=x;
+  lcd_hw_y=y;
+}
+
+static void LCD_Blink(bool status)
+{
+  LCD_Byte(0x1F);
+  LCD_Byte(0x43);
+  if (status) LCD_Byte(1);
+  else LCD_Byte(0);
+  lcd_blink_shown=status;
 }
 
 static void LCD_Init()
 {
+  int i;
+
   LCD_Busy.config();
   LCD_Clk.config();
   LCD_Data.config();
@@ -1986,24 +2746,38 @@ static void LCD_Init()
   LCD_Reset=1;
   while (LCD_Busy.read());
   //LED1=0;
+
+  //falling edge on busy sends the next queued byte
+  lcd_head=0;
+  lcd_tail=0;
+  LPC_GPIO0->IS&=~BIT4;
+  LPC_GPIO0->IBE&=~BIT4;
+  LPC_GPIO0->IEV&=~BIT4;
+  LPC_GPIO0->IC=BIT4;
+  LPC_GPIO0->IE|=BIT4;
+  NVIC_EnableIRQ(EINT0_IRQn);
+
+  //blank after reset with the cursor at the top left
+  LCD_Clear();
+  for (i=0;i<SCREEN_ROWS*SCREEN_WIDTH;i++) lcd_shown[i]=' ';
+  lcd_hw_x=0;
+  lcd_hw_y=0;
+  lcd_blink=false;
+  lcd_blink_shown=false;
 }
 
+//Blinks where the cursor is now once flushed
 static void SetBlink(bool status)
 {
-  LCD_Byte(0x1F);
-  LCD_Byte(0x43);
-  if (status) LCD_Byte(1);
-  else LCD_Byte(0);
+  lcd_blink=status;
+  lcd_blink_x=lcd_x;
+  lcd_blink_y=lcd_y;
 }
 
 static void gotoxy(short x, short y)
 {
-  LCD_Byte(0x1F);
-  LCD_Byte(0x24);
-  LCD_Byte(x*7);
-  LCD_Byte(0);
-  LCD_Byte(y);
-  LCD_Byte(0);
+  lcd_x=x;
+  lcd_y=y;
 }
 
 static unsigned char GetKey()
@@ -2012,8 +2786,12 @@ static unsigned char GetKey()
   bool Fn=false;
   volatile unsigned char retval=0,key=0;
   int i,j;
+
+  //whatever was drawn goes out before waiting
+  LCD_Flush();
   while (1)
   {
+    LCD_Next();
     for (j=0;j<2;j++)
     {
       if (j==0)
@@ -2025,8 +2803,8 @@ static unsigned char GetKey()
       KeyOUT_B=1;
       KeyOUT_C=1;
       KeyOUT_D=1;
-      KeyOUT_E=1;
-      KeyOUT_F=1;
+      GPIO1_Write(KEY_OUT_E_BIT,1);
+      GPIO1_Write(KEY_OUT_F_BIT,1);
       retval=0;
       for (i=0;i<6;i++)
       {
@@ -2049,11 +2827,11 @@ static unsigned char GetKey()
             break;
           case 4:
             KeyOUT_D=1;
-            KeyOUT_E=0;
+            GPIO1_Write(KEY_OUT_E_BIT,0);
             break;
           case 5:
-            KeyOUT_E=1;
-            KeyOUT_F=0;
+            GPIO1_Write(KEY_OUT_E_BIT,1);
+            GPIO1_Write(KEY_OUT_F_BIT,0);
             break;
         }
         //delay_ms(10);
@@ -2084,7 +2862,12 @@ static unsigned char GetKey()
             else if (KeyMatrix[i*5+retval]==KEY_FN) retval=0;
             else
             {
-              if (shift)
+              if ((shift)&&(Fn))
+              {
+                delay_ms(10);
+                key=KeyMatrixHyp[i*5+retval];
+              }
+              else if (shift)
               {
                 delay_ms(10);//debounce
                 //LCD_Text("&");
@@ -2129,6 +2912,28 @@ static unsigned char GetKey()
   return retval;
 }
 
+//True if any key is down. Doesn't wait for it
+static bool KeyWaiting()
+{
+  bool retval;
+
+  LCD_Next();
+  KeyOUT_A=0;
+  KeyOUT_B=0;
+  KeyOUT_C=0;
+  KeyOUT_D=0;
+  GPIO1_Write(KEY_OUT_E_BIT,0);
+  GPIO1_Write(KEY_OUT_F_BIT,0);
+  retval=(!KeyIN_A.read())||(!KeyIN_B.read())||(!KeyIN_C.read())||(!KeyIN_D.read())||(!KeyIN_E.read());
+  KeyOUT_A=1;
+  KeyOUT_B=1;
+  KeyOUT_C=1;
+  KeyOUT_D=1;
+  GPIO1_Write(KEY_OUT_E_BIT,1);
+  GPIO1_Write(KEY_OUT_F_BIT,1);
+  return retval;
+}
+
 static unsigned char GetKeyEmu()
 {
   static int counter=0;
@@ -2168,7 +2973,7 @@ static void SPI_Init()
 
   SPI_CS.config();
 
-  SPI_CS=1;
+  GPIO1_Write(SPI_CS_BIT,1);
 
   LPC_SYSCON->PRESETCTRL |= BIT0;     //Table 9 - Reset SPI0
   LPC_SYSCON->SYSAHBCLKCTRL |= BIT11;  //Table 21 - Enable clock
@@ -2212,300 +3017,110 @@ static void Key_Init()
   KeyOUT_B=1;
   KeyOUT_C=1;
   KeyOUT_D=1;
-  KeyOUT_E=1;
-  KeyOUT_F=1;
+  GPIO1_Write(KEY_OUT_E_BIT,1);
+  GPIO1_Write(KEY_OUT_F_BIT,1);
 }
 
-static unsigned char RAM_Read(const unsigned char *a1)
+//Sends command and address. The RAM is in sequential mode so bytes keep
+//coming or going from the next address until CS goes high
+static void RAM_Start(unsigned char command, const unsigned char *a1)
 {
-  unsigned char retval;
-  SPI_CS=0;
-  SPI_Send(SPI_READ);
+  GPIO1_Write(SPI_CS_BIT,0);
+  SPI_Send(command);
   SPI_Send(which_stack);
   SPI_Send(((unsigned int)a1)>>8);
   SPI_Send(((unsigned int)a1)&0xFF);
+}
+
+static unsigned char RAM_Read(const unsigned char *a1)
+{
+  unsigned char retval;
+  RAM_Start(SPI_READ,a1);
   retval=SPI_Send(0);
-  SPI_CS=1;
+  GPIO1_Write(SPI_CS_BIT,1);
   return retval;
 }
 
 static void RAM_Write(const unsigned char *a1, const unsigned char byte)
 {
-  SPI_CS=0;
-  SPI_Send(SPI_WRITE);
-  SPI_Send(which_stack);
-  SPI_Send(((unsigned int)a1)>>8);
-  SPI_Send(((unsigned int)a1)&0xFF);
+  RAM_Start(SPI_WRITE,a1);
   SPI_Send(byte);
-  SPI_CS=1;
+  GPIO1_Write(SPI_CS_BIT,1);
+}
+
+static void RAM_ReadBlock(unsigned char *dest, const unsigned char *a1, unsigned int count)
+{
+  RAM_Start(SPI_READ,a1);
+  while (count--) *dest++=SPI_Send(0);
+  GPIO1_Write(SPI_CS_BIT,1);
+}
+
+static void RAM_WriteBlock(const unsigned char *a1, const unsigned char *src, unsigned int count)
+{
+  RAM_Start(SPI_WRITE,a1);
+  while (count--) SPI_Send(*src++);
+  GPIO1_Write(SPI_CS_BIT,1);
 }
 
 //maybe BCD isn't that efficient
+//Tables are generated by MakeTables.py into MathTables.h
 static void MakeTables()
 {
-  //Log table
-  static const unsigned char table[]={
-  17 ,0x88,0x72,0x28,0x39,0x11,0x16,0x72,0x99,0x96,0x05,0x40,0x57,0x11,0x54,0x66,0x46,0x60,
-  17 ,0x44,0x36,0x14,0x19,0x55,0x58,0x36,0x49,0x98,0x02,0x70,0x28,0x55,0x77,0x33,0x23,0x30,
-  17 ,0x22,0x18,0x07,0x09,0x77,0x79,0x18,0x24,0x99,0x01,0x35,0x14,0x27,0x88,0x66,0x61,0x65,
-  17 ,0x11,0x09,0x03,0x54,0x88,0x89,0x59,0x12,0x49,0x50,0x67,0x57,0x13,0x94,0x33,0x30,0x83,
-  17 ,0x05,0x54,0x51,0x77,0x44,0x44,0x79,0x56,0x24,0x75,0x33,0x78,0x56,0x97,0x16,0x65,0x41,
-  17 ,0x02,0x77,0x25,0x88,0x72,0x22,0x39,0x78,0x12,0x37,0x66,0x89,0x28,0x48,0x58,0x32,0x71,
-  17 ,0x01,0x38,0x62,0x94,0x36,0x11,0x19,0x89,0x06,0x18,0x83,0x44,0x64,0x24,0x29,0x16,0x35,
-  16 ,0x69,0x31,0x47,0x18,0x05,0x59,0x94,0x53,0x09,0x41,0x72,0x32,0x12,0x14,0x58,0x18,
-  16 ,0x40,0x54,0x65,0x10,0x81,0x08,0x16,0x43,0x81,0x97,0x80,0x13,0x11,0x54,0x64,0x35,
-  16 ,0x22,0x31,0x43,0x55,0x13,0x14,0x20,0x97,0x55,0x76,0x62,0x95,0x09,0x03,0x09,0x83,
-  16 ,0x11,0x77,0x83,0x03,0x56,0x56,0x38,0x34,0x54,0x53,0x87,0x94,0x10,0x94,0x70,0x52,
-  16 ,0x06,0x06,0x24,0x62,0x18,0x16,0x43,0x48,0x42,0x58,0x06,0x06,0x13,0x20,0x40,0x42,
-  16 ,0x03,0x07,0x71,0x65,0x86,0x66,0x75,0x36,0x88,0x37,0x10,0x28,0x20,0x75,0x96,0x77,
-  16 ,0x01,0x55,0x04,0x18,0x65,0x35,0x96,0x52,0x54,0x15,0x08,0x54,0x04,0x60,0x42,0x45,
-  15 ,0x77,0x82,0x14,0x04,0x42,0x05,0x49,0x48,0x94,0x74,0x62,0x90,0x00,0x61,0x14,
-  15 ,0x38,0x98,0x64,0x04,0x15,0x65,0x73,0x23,0x01,0x39,0x37,0x34,0x30,0x95,0x84,
-  15 ,0x19,0x51,0x22,0x01,0x31,0x26,0x17,0x49,0x43,0x96,0x74,0x04,0x95,0x31,0x84,
-  15 ,0x09,0x76,0x08,0x59,0x73,0x05,0x54,0x58,0x89,0x59,0x60,0x82,0x49,0x08,0x02,
-  15 ,0x04,0x88,0x16,0x20,0x79,0x50,0x13,0x51,0x18,0x85,0x37,0x04,0x96,0x92,0x65,
-  15 ,0x02,0x44,0x11,0x08,0x27,0x52,0x73,0x62,0x70,0x91,0x60,0x47,0x90,0x85,0x82,
-  15 ,0x01,0x22,0x06,0x28,0x62,0x52,0x56,0x77,0x37,0x16,0x23,0x05,0x53,0x67,0x16,
-  14 ,0x61,0x03,0x32,0x93,0x68,0x06,0x38,0x52,0x49,0x13,0x15,0x87,0x89,0x65,
-  14 ,0x30,0x51,0x71,0x12,0x47,0x31,0x86,0x37,0x85,0x69,0x06,0x95,0x14,0x17,
-  14 ,0x15,0x25,0x86,0x72,0x64,0x83,0x62,0x39,0x74,0x05,0x75,0x73,0x25,0x13,
-  14 ,0x07,0x62,0x93,0x65,0x42,0x75,0x67,0x57,0x21,0x55,0x88,0x52,0x96,0x85,
-  14 ,0x03,0x81,0x46,0x89,0x98,0x96,0x85,0x88,0x94,0x80,0x71,0x17,0x84,0x98,
-  14 ,0x01,0x90,0x73,0x46,0x81,0x38,0x25,0x40,0x94,0x15,0x46,0x94,0x42,0x51,
-  13 ,0x95,0x36,0x73,0x86,0x16,0x59,0x18,0x82,0x33,0x90,0x84,0x15,0x51,
-  13 ,0x47,0x68,0x37,0x04,0x45,0x16,0x32,0x34,0x18,0x44,0x34,0x61,0x75,
-  13 ,0x23,0x84,0x18,0x55,0x06,0x79,0x85,0x75,0x87,0x10,0x42,0x36,0x79,
-  13 ,0x11,0x92,0x09,0x28,0x24,0x45,0x35,0x44,0x57,0x08,0x75,0x79,0x16,
-  13 ,0x05,0x96,0x04,0x64,0x29,0x99,0x03,0x38,0x56,0x18,0x58,0x25,0x32,
-  13 ,0x02,0x98,0x02,0x32,0x19,0x43,0x60,0x61,0x11,0x47,0x31,0x97,0x05,
-  13 ,0x01,0x49,0x01,0x16,0x10,0x82,0x82,0x53,0x54,0x89,0x03,0x91,0x82,
-  12 ,0x74,0x50,0x58,0x05,0x69,0x16,0x82,0x52,0x64,0x72,0x34,0x52,
-  12 ,0x37,0x25,0x29,0x02,0x91,0x52,0x30,0x20,0x17,0x58,0x25,0x70,
-  12 ,0x18,0x62,0x64,0x51,0x47,0x49,0x62,0x33,0x55,0x74,0x27,0x31,
-  12 ,0x09,0x31,0x32,0x25,0x74,0x18,0x17,0x97,0x64,0x69,0x00,0x06,
-  12 ,0x04,0x65,0x66,0x12,0x87,0x19,0x93,0x19,0x04,0x05,0x97,0x61,
-  12 ,0x02,0x32,0x83,0x06,0x43,0x62,0x67,0x64,0x57,0x45,0x98,0x32,
-  12 ,0x01,0x16,0x41,0x53,0x21,0x82,0x01,0x58,0x55,0x08,0x75,0x62,
-  11 ,0x58,0x20,0x76,0x60,0x91,0x17,0x73,0x34,0x13,0x32,0x12,
-  11 ,0x29,0x10,0x38,0x30,0x45,0x63,0x10,0x18,0x71,0x39,0x66,
-  11 ,0x14,0x55,0x19,0x15,0x22,0x82,0x60,0x97,0x26,0x88,0x23,
-  11 ,0x07,0x27,0x59,0x57,0x61,0x41,0x56,0x95,0x61,0x23,0x72,
-  11 ,0x03,0x63,0x79,0x78,0x80,0x70,0x85,0x09,0x55,0x06,0x76,
-  11 ,0x01,0x81,0x89,0x89,0x40,0x35,0x44,0x20,0x21,0x14,0x60,
-  10 ,0x90,0x94,0x94,0x70,0x17,0x72,0x51,0x46,0x47,0x61,
-  10 ,0x45,0x47,0x47,0x35,0x08,0x86,0x36,0x07,0x21,0x38,
-  10 ,0x22,0x73,0x73,0x67,0x54,0x43,0x20,0x62,0x10,0x08,
-  10 ,0x11,0x36,0x86,0x83,0x77,0x21,0x60,0x95,0x67,0x39,
-  10 ,0x05,0x68,0x43,0x41,0x88,0x60,0x80,0x63,0x99,0x28,
-  10 ,0x02,0x84,0x21,0x70,0x94,0x30,0x40,0x36,0x03,0x54,
-  10 ,0x01,0x42,0x10,0x85,0x47,0x15,0x20,0x19,0x02,0x74,
-  9 ,0x71,0x05,0x42,0x73,0x57,0x60,0x09,0x76,0x61,
-  9 ,0x35,0x52,0x71,0x36,0x78,0x80,0x04,0x94,0x62,
-  9 ,0x17,0x76,0x35,0x68,0x39,0x40,0x02,0x48,0x89,
-  9 ,0x08,0x88,0x17,0x84,0x19,0x70,0x01,0x24,0x84,
-  9 ,0x04,0x44,0x08,0x92,0x09,0x85,0x00,0x62,0x52,
-  9 ,0x02,0x22,0x04,0x46,0x04,0x92,0x50,0x31,0x28,
-  9 ,0x01,0x11,0x02,0x23,0x02,0x46,0x25,0x15,0x65,
-  8 ,0x55,0x51,0x11,0x51,0x23,0x12,0x57,0x83,
-  8 ,0x27,0x75,0x55,0x75,0x61,0x56,0x28,0x91,
-  8 ,0x13,0x87,0x77,0x87,0x80,0x78,0x14,0x46,
-  8 ,0x06,0x93,0x88,0x93,0x90,0x39,0x07,0x23,
-  8 ,0x03,0x46,0x94,0x46,0x95,0x19,0x53,0x61,
-  8 ,0x01,0x73,0x47,0x23,0x47,0x59,0x76,0x81,
-  7 ,0x86,0x73,0x61,0x73,0x79,0x88,0x40,
-  7 ,0x43,0x36,0x80,0x86,0x89,0x94,0x20,
-  7 ,0x21,0x68,0x40,0x43,0x44,0x97,0x10,
-  7 ,0x10,0x84,0x20,0x21,0x72,0x48,0x55,
-  7 ,0x05,0x42,0x10,0x10,0x86,0x24,0x27,
-  7 ,0x02,0x71,0x05,0x05,0x43,0x12,0x14,
-  7 ,0x01,0x35,0x52,0x52,0x71,0x56,0x07,
-  6 ,0x67,0x76,0x26,0x35,0x78,0x03,
-  6 ,0x33,0x88,0x13,0x17,0x89,0x02,
-  6 ,0x16,0x94,0x06,0x58,0x94,0x51,
-  6 ,0x08,0x47,0x03,0x29,0x47,0x25,
-  6 ,0x04,0x23,0x51,0x64,0x73,0x63,
-  6 ,0x02,0x11,0x75,0x82,0x36,0x81,
-  6 ,0x01,0x05,0x87,0x91,0x18,0x41,
-  5 ,0x52,0x93,0x95,0x59,0x20,
-  5 ,0x26,0x46,0x97,0x79,0x60,
-  5 ,0x13,0x23,0x48,0x89,0x80,
-  5 ,0x06,0x61,0x74,0x44,0x90,
-  5 ,0x03,0x30,0x87,0x22,0x45,
-  5 ,0x01,0x65,0x43,0x61,0x22,
-  4 ,0x82,0x71,0x80,0x61,
-  4 ,0x41,0x35,0x90,0x31,
-  4 ,0x20,0x67,0x95,0x15,
-  4 ,0x10,0x33,0x97,0x58,
-  4 ,0x05,0x16,0x98,0x79,
-  4 ,0x02,0x58,0x49,0x39,
-  4 ,0x01,0x29,0x24,0x70,
-  3 ,0x64,0x62,0x35,
-  3 ,0x32,0x31,0x17,
-  3 ,0x16,0x15,0x59,
-  3 ,0x08,0x07,0x79,
-  3 ,0x04,0x03,0x90,
-  3 ,0x02,0x01,0x95,
-  3 ,0x01,0x00,0x97,
-  2 ,0x50,0x49,
-  2 ,0x25,0x24,
-  2 ,0x12,0x62,
-  2 ,0x06,0x31,
-  2 ,0x03,0x15,
-  2 ,0x01,0x58,
-  1 ,0x79,
-  1 ,0x39,
-  1 ,0x20,
-  1 ,0x10,
-  1 ,0x05,
-  1 ,0x02,
-  1 ,0x01,
-  //Trig table
-  //this could be done by doubling
-  17 ,0x45,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  17 ,0x26,0x56,0x50,0x51,0x17,0x70,0x77,0x98,0x93,0x51,0x57,0x21,0x93,0x72,0x04,0x53,0x29,
-  17 ,0x14,0x03,0x62,0x43,0x46,0x79,0x26,0x47,0x85,0x82,0x89,0x23,0x20,0x15,0x91,0x63,0x42,
-  17 ,0x07,0x12,0x50,0x16,0x34,0x89,0x01,0x79,0x75,0x61,0x95,0x33,0x00,0x84,0x12,0x06,0x84,
-  17 ,0x03,0x57,0x63,0x34,0x37,0x49,0x97,0x35,0x10,0x30,0x68,0x47,0x78,0x91,0x44,0x58,0x82,
-  17 ,0x01,0x78,0x99,0x10,0x60,0x82,0x46,0x06,0x93,0x07,0x15,0x02,0x49,0x77,0x60,0x79,0x09,
-  16 ,0x89,0x51,0x73,0x71,0x02,0x11,0x07,0x43,0x13,0x64,0x12,0x16,0x82,0x30,0x79,0x53,
-  16 ,0x44,0x76,0x14,0x17,0x08,0x60,0x55,0x30,0x73,0x09,0x43,0x53,0x82,0x54,0x23,0x82,
-  16 ,0x22,0x38,0x10,0x50,0x03,0x68,0x53,0x80,0x75,0x12,0x35,0x33,0x54,0x24,0x30,0x59,
-  16 ,0x11,0x19,0x05,0x67,0x70,0x66,0x20,0x68,0x87,0x27,0x54,0x75,0x79,0x70,0x34,0x72,
-  16 ,0x05,0x59,0x52,0x89,0x18,0x93,0x80,0x36,0x68,0x17,0x44,0x24,0x13,0x44,0x04,0x23,
-  16 ,0x02,0x79,0x76,0x45,0x26,0x17,0x00,0x36,0x74,0x59,0x91,0x79,0x11,0x92,0x36,0x83,
-  16 ,0x01,0x39,0x88,0x22,0x71,0x42,0x26,0x50,0x14,0x62,0x86,0x87,0x63,0x57,0x24,0x36,
-  15 ,0x69,0x94,0x11,0x36,0x75,0x35,0x29,0x18,0x45,0x75,0x24,0x89,0x32,0x87,0x82,
-  15 ,0x34,0x97,0x05,0x68,0x50,0x70,0x40,0x11,0x05,0x84,0x42,0x77,0x35,0x40,0x77,
-  15 ,0x17,0x48,0x52,0x84,0x26,0x98,0x04,0x49,0x52,0x15,0x80,0x88,0x73,0x44,0x18,
-  15 ,0x08,0x74,0x26,0x42,0x13,0x69,0x37,0x80,0x26,0x02,0x61,0x92,0x68,0x64,0x27,
-  15 ,0x04,0x37,0x13,0x21,0x06,0x87,0x23,0x34,0x56,0x75,0x78,0x22,0x83,0x81,0x83,
-  15 ,0x02,0x18,0x56,0x60,0x53,0x43,0x93,0x47,0x83,0x84,0x70,0x43,0x88,0x58,0x09,
-  15 ,0x01,0x09,0x28,0x30,0x26,0x72,0x00,0x71,0x48,0x85,0x70,0x39,0x80,0x29,0x58,
-  14 ,0x54,0x64,0x15,0x13,0x36,0x00,0x85,0x44,0x04,0x52,0x09,0x67,0x46,0x64,
-  14 ,0x27,0x32,0x07,0x56,0x68,0x00,0x48,0x93,0x22,0x46,0x91,0x06,0x02,0x51,
-  14 ,0x13,0x66,0x03,0x78,0x34,0x00,0x25,0x24,0x26,0x26,0x06,0x30,0x80,0x30,
-  14 ,0x06,0x83,0x01,0x89,0x17,0x00,0x12,0x71,0x83,0x75,0x85,0x75,0x12,0x55,
-  14 ,0x03,0x41,0x50,0x94,0x58,0x50,0x06,0x37,0x13,0x20,0x78,0x20,0x02,0x82,
-  14 ,0x01,0x70,0x75,0x47,0x29,0x25,0x03,0x18,0x71,0x76,0x99,0x76,0x57,0x23,
-  13 ,0x85,0x37,0x73,0x64,0x62,0x51,0x59,0x37,0x78,0x07,0x46,0x60,0x59,
-  13 ,0x42,0x68,0x86,0x82,0x31,0x25,0x79,0x69,0x12,0x73,0x43,0x09,0x29,
-  13 ,0x21,0x34,0x43,0x41,0x15,0x62,0x89,0x84,0x59,0x32,0x92,0x77,0x02,
-  13 ,0x10,0x67,0x21,0x70,0x57,0x81,0x44,0x92,0x30,0x03,0x49,0x03,0x81,
-  13 ,0x05,0x33,0x60,0x85,0x28,0x90,0x72,0x46,0x15,0x06,0x37,0x35,0x07,
-  13 ,0x02,0x66,0x80,0x42,0x64,0x45,0x36,0x23,0x07,0x53,0x76,0x52,0x93,
-  13 ,0x01,0x33,0x40,0x21,0x32,0x22,0x68,0x11,0x53,0x76,0x95,0x49,0x64,
-  12 ,0x66,0x70,0x10,0x66,0x11,0x34,0x05,0x76,0x88,0x48,0x65,0x22,
-  12 ,0x33,0x35,0x05,0x33,0x05,0x67,0x02,0x88,0x44,0x24,0x43,0x91,
-  12 ,0x16,0x67,0x52,0x66,0x52,0x83,0x51,0x44,0x22,0x12,0x23,0x37,
-  12 ,0x08,0x33,0x76,0x33,0x26,0x41,0x75,0x72,0x11,0x06,0x11,0x86,
-  12 ,0x04,0x16,0x88,0x16,0x63,0x20,0x87,0x86,0x05,0x53,0x05,0x95,
-  12 ,0x02,0x08,0x44,0x08,0x31,0x60,0x43,0x93,0x02,0x76,0x52,0x98,
-  12 ,0x01,0x04,0x22,0x04,0x15,0x80,0x21,0x96,0x51,0x38,0x26,0x49,
-  11 ,0x52,0x11,0x02,0x07,0x90,0x10,0x98,0x25,0x69,0x13,0x24,
-  11 ,0x26,0x05,0x51,0x03,0x95,0x05,0x49,0x12,0x84,0x56,0x62,
-  11 ,0x13,0x02,0x75,0x51,0x97,0x52,0x74,0x56,0x42,0x28,0x31,
-  11 ,0x06,0x51,0x37,0x75,0x98,0x76,0x37,0x28,0x21,0x14,0x16,
-  11 ,0x03,0x25,0x68,0x87,0x99,0x38,0x18,0x64,0x10,0x57,0x08,
-  11 ,0x01,0x62,0x84,0x43,0x99,0x69,0x09,0x32,0x05,0x28,0x54,
-  10 ,0x81,0x42,0x21,0x99,0x84,0x54,0x66,0x02,0x64,0x27,
-  10 ,0x40,0x71,0x10,0x99,0x92,0x27,0x33,0x01,0x32,0x13,
-  10 ,0x20,0x35,0x55,0x49,0x96,0x13,0x66,0x50,0x66,0x07,
-  10 ,0x10,0x17,0x77,0x74,0x98,0x06,0x83,0x25,0x33,0x03,
-  10 ,0x05,0x08,0x88,0x87,0x49,0x03,0x41,0x62,0x66,0x52,
-  10 ,0x02,0x54,0x44,0x43,0x74,0x51,0x70,0x81,0x33,0x26,
-  10 ,0x01,0x27,0x22,0x21,0x87,0x25,0x85,0x40,0x66,0x63,
-  9 ,0x63,0x61,0x10,0x93,0x62,0x92,0x70,0x33,0x31,
-  9 ,0x31,0x80,0x55,0x46,0x81,0x46,0x35,0x16,0x66,
-  9 ,0x15,0x90,0x27,0x73,0x40,0x73,0x17,0x58,0x33,
-  9 ,0x07,0x95,0x13,0x86,0x70,0x36,0x58,0x79,0x16,
-  9 ,0x03,0x97,0x56,0x93,0x35,0x18,0x29,0x39,0x58,
-  9 ,0x01,0x98,0x78,0x46,0x67,0x59,0x14,0x69,0x79,
-  8 ,0x99,0x39,0x23,0x33,0x79,0x57,0x34,0x90,
-  8 ,0x49,0x69,0x61,0x66,0x89,0x78,0x67,0x45,
-  8 ,0x24,0x84,0x80,0x83,0x44,0x89,0x33,0x72,
-  8 ,0x12,0x42,0x40,0x41,0x72,0x44,0x66,0x86,
-  8 ,0x06,0x21,0x20,0x20,0x86,0x22,0x33,0x43,
-  8 ,0x03,0x10,0x60,0x10,0x43,0x11,0x16,0x72,
-  8 ,0x01,0x55,0x30,0x05,0x21,0x55,0x58,0x36,
-  7 ,0x77,0x65,0x02,0x60,0x77,0x79,0x18,
-  7 ,0x38,0x82,0x51,0x30,0x38,0x89,0x59,
-  7 ,0x19,0x41,0x25,0x65,0x19,0x44,0x79,
-  7 ,0x09,0x70,0x62,0x82,0x59,0x72,0x40,
-  7 ,0x04,0x85,0x31,0x41,0x29,0x86,0x20,
-  7 ,0x02,0x42,0x65,0x70,0x64,0x93,0x10,
-  7 ,0x01,0x21,0x32,0x85,0x32,0x46,0x55,
-  6 ,0x60,0x66,0x42,0x66,0x23,0x27,
-  6 ,0x30,0x33,0x21,0x33,0x11,0x64,
-  6 ,0x15,0x16,0x60,0x66,0x55,0x82,
-  6 ,0x07,0x58,0x30,0x33,0x27,0x91,
-  6 ,0x03,0x79,0x15,0x16,0x63,0x95,
-  6 ,0x01,0x89,0x57,0x58,0x31,0x98,
-  5 ,0x94,0x78,0x79,0x15,0x99,
-  5 ,0x47,0x39,0x39,0x57,0x99,
-  5 ,0x23,0x69,0x69,0x79,0x00,
-  5 ,0x11,0x84,0x84,0x89,0x50,
-  5 ,0x05,0x92,0x42,0x44,0x75,
-  5 ,0x02,0x96,0x21,0x22,0x37,
-  5 ,0x01,0x48,0x10,0x61,0x19,
-  4 ,0x74,0x05,0x30,0x59,
-  4 ,0x37,0x02,0x65,0x30,
-  4 ,0x18,0x51,0x32,0x65,
-  4 ,0x09,0x25,0x66,0x32,
-  4 ,0x04,0x62,0x83,0x16,
-  4 ,0x02,0x31,0x41,0x58,
-  4 ,0x01,0x15,0x70,0x79,
-  3 ,0x57,0x85,0x40,
-  3 ,0x28,0x92,0x70,
-  3 ,0x14,0x46,0x35,
-  3 ,0x07,0x23,0x17,
-  3 ,0x03,0x61,0x59,
-  3 ,0x01,0x80,0x79,
-  2 ,0x90,0x40,
-  2 ,0x45,0x20,
-  2 ,0x22,0x60,
-  2 ,0x11,0x30,
-  2 ,0x05,0x65,
-  2 ,0x02,0x82,
-  2 ,0x01,0x41,
-  1 ,0x71,
-  1 ,0x35,
-  1 ,0x18,
-  1 ,0x09,
-  1 ,0x04,
-  1 ,0x02,
-  1 ,0x01,
-  0};
+  UnpackTable(logs,LogTable);
+  UnpackTable(trig,TrigTable);
+  UnpackTable(hyper,HypTable);
+}
 
+static void UnpackTable(unsigned char *dest, const unsigned char *table)
+{
   int i,i_end;
-  int table_ptr=0,log_ptr=0;
+  int table_ptr=0,dest_ptr=0,buff_ptr;
+
+  //each entry is built in ext_buff and written in one go
   do
   {
-    logs[log_ptr+BCD_SIGN]=0;
-    logs[log_ptr+BCD_DEC]=2;
-    logs[log_ptr+BCD_LEN]=34;
-    log_ptr+=3;
+    ext_buff[BCD_SIGN]=0;
+    ext_buff[BCD_DEC]=2;
+    ext_buff[BCD_LEN]=MATH_DIGITS+2;
+    buff_ptr=3;
     i_end=table[table_ptr];
     table_ptr++;
-    for (i=0;i<(17-i_end);i++)
+    for (i=0;i<((MATH_DIGITS+2)/2-i_end);i++)
     {
-      logs[log_ptr++]=0;
-      logs[log_ptr++]=0;
+      ext_buff[buff_ptr++]=0;
+      ext_buff[buff_ptr++]=0;
     }
     for (i=0;i<i_end;i++)
     {
-      logs[log_ptr]=table[table_ptr]>>4;
-      logs[log_ptr+1]=table[table_ptr]&0xF;
+      ext_buff[buff_ptr]=table[table_ptr]>>4;
+      ext_buff[buff_ptr+1]=table[table_ptr]&0xF;
       table_ptr++;
-      log_ptr+=2;
+      buff_ptr+=2;
     }
+    RAM_WriteBlock(dest+dest_ptr,ext_buff,buff_ptr);
+    dest_ptr+=buff_ptr;
   } while(table[table_ptr]);
 }
 
+//Only works out the precisions. SetTables cuts the tables to match when a
+//key needs them
 static void SetDecPlaces()
+{
+  Settings.WorkPlaces=Settings.DecPlaces+GUARD_DIGITS;
+  Settings.TablePlaces=Settings.WorkPlaces;
+  if (Settings.TablePlaces>MATH_DIGITS) Settings.TablePlaces=MATH_DIGITS;
+}
+
+//Rewrites every table LEN byte over SPI so it's skipped when the tables
+//are already at TablePlaces
+static void SetTables()
 {
   int i,j=2,x;
   //unsigned char which_backup=which_stack;
 
+  if (Settings.TablePlaces==table_places) return;
+  table_places=Settings.TablePlaces;
+
   //for (x=0;x<2;x++)
   //{
     //which_stack=x;
@@ -2513,105 +3128,113 @@ static void SetDecPlaces()
     j=2;
     for (i=0;i<MATH_TRIG_TABLE;i++)
     {
-      trig[i*MATH_ENTRY_SIZE+BCD_LEN]=j+Settings.DecPlaces;
+      trig[i*MATH_ENTRY_SIZE+BCD_LEN]=j+Settings.TablePlaces;
       if (IsZero(trig+i*MATH_ENTRY_SIZE)) break;
     }
-    Settings.TrigTableSize=i+1;
+    //no zero entry at full precision so don't run past the end of the table
+    if (i<MATH_TRIG_TABLE) i++;
+    Settings.TrigTableSize=i;
     for (i=0;i<MATH_LOG_TABLE;i++)
     {
-      logs[i*MATH_ENTRY_SIZE+BCD_LEN]=j+Settings.DecPlaces;
+      logs[i*MATH_ENTRY_SIZE+BCD_LEN]=j+Settings.TablePlaces;
       if (IsZero(logs+i*MATH_ENTRY_SIZE)) break;
     }
-    Settings.LogTableSize=i+1;//this was +0 on slave
+    if (i<MATH_LOG_TABLE) i++;
+    Settings.LogTableSize=i;//this was +0 on slave
+    for (i=0;i<MATH_HYP_TABLE;i++)
+    {
+      hyper[i*MATH_ENTRY_SIZE+BCD_LEN]=j+Settings.TablePlaces;
+      if (IsZero(hyper+i*MATH_ENTRY_SIZE)) break;
+    }
+    if (i<MATH_HYP_TABLE) i++;
+    Settings.HypTableSize=i;
 
-    perm_K[BCD_LEN]=1+Settings.DecPlaces;
-    perm_log10[BCD_LEN]=1+Settings.DecPlaces;
+    perm_K[BCD_LEN]=1+Settings.TablePlaces;
+    perm_Kh[BCD_LEN]=1+Settings.TablePlaces;
+    perm_log10[BCD_LEN]=1+Settings.TablePlaces;
+    perm_deg[BCD_LEN]=2+Settings.TablePlaces;
   //}
   //which_stack=which_backup;
+
+  HotBuild();
 }
 
-static void BufferBCD_EtI(const unsigned char *text, unsigned char *BCD)
+static unsigned char *TableBase(unsigned char table)
 {
-  #pragma MM_VAR text
-  //#pragma MM_VAR BCD
-
-  unsigned char *RAM_ptr;
-  int BCD_ptr=3,text_ptr=0;
-  char found=0;
+  if (table==TABLE_LOG) return logs;
+  else if (table==TABLE_TRIG) return trig;
+  return hyper;
+}
 
-  if (text[0]=='-')
-  {
-    text++;
-    BCD[BCD_SIGN]=1;
-  }
-  else BCD[BCD_SIGN]=0;
+//Packs leading entries of all three tables into hot_table, one entry of
+//each table in turn, until HOT_BYTES is used up
+static void HotBuild()
+{
+  unsigned int i,table,used=0;
+  unsigned int sizes[3];
 
-  BCD[BCD_LEN]=0;
-  BCD[BCD_DEC]=0;
+  sizes[TABLE_LOG]=Settings.LogTableSize;
+  sizes[TABLE_TRIG]=Settings.TrigTableSize;
+  sizes[TABLE_HYP]=Settings.HypTableSize;
+  hot_len=Settings.TablePlaces+2;
 
-  while (text[text_ptr])
+  for (table=0;table<3;table++) hot_count[table]=0;
+  for (i=0;i<HOT_ENTRIES;i++)
   {
-    if (text[text_ptr]=='.')
-    {
-      BCD[BCD_DEC]=text_ptr;
-      found=1;
-    }
-    else
+    for (table=0;table<3;table++)
     {
-      BCD[BCD_ptr]=text[text_ptr]-'0';
-      BCD_ptr++;
+      //stopped if an earlier entry didn't fit
+      if ((hot_count[table]!=i)||(i>=sizes[table])) continue;
+      hot_offset[table][i]=used;
+      if (HotPack(TableBase(table)+i*MATH_ENTRY_SIZE,&used)) hot_count[table]++;
     }
-    text_ptr++;
   }
-  BCD[BCD_LEN]=text_ptr-found;
-  if (found==0) BCD[BCD_DEC]=BCD[BCD_LEN];
 }
 
-static void ImmedBCD(const char *text, unsigned char *BCD)
+static bool HotPack(unsigned char *entry, unsigned int *used)
 {
-  int text_ptr=0;
-  do
+  unsigned int i,zeros;
+
+  RAM_ReadBlock(ext_buff,entry,hot_len+3);
+  for (zeros=0;zeros<hot_len;zeros++)
   {
-    perm_buff2[text_ptr]=(unsigned char)text[text_ptr];
-  } while(text[text_ptr++]);
-  BufferBCD_ItE(perm_buff2,BCD);
+    if (ext_buff[zeros+3]) break;
+  }
+  if (*used+1+(hot_len-zeros+1)/2>HOT_BYTES) return false;
+
+  hot_table[(*used)++]=zeros;
+  for (i=zeros;i<hot_len;i+=2)
+  {
+    hot_table[*used]=ext_buff[i+3]<<4;
+    if ((i+1)<hot_len) hot_table[*used]|=ext_buff[i+4];
+    (*used)++;
+  }
+  return true;
 }
 
-static void BufferBCD_ItE(const unsigned char *text, unsigned char *BCD)
+//Table entry i at the current precision from hot_table or external RAM
+static void TableEntry(unsigned char *dest, unsigned char table, unsigned int i)
 {
-  //#pragma MM_VAR text
-  #pragma MM_VAR BCD
-
-  unsigned char *RAM_ptr;
-  int BCD_ptr=3,text_ptr=0;
-  char found=0;
+  unsigned char *hot;
+  unsigned int j,zeros;
 
-  if (text[0]=='-')
+  if (i>=hot_count[table])
   {
-    text++;
-    BCD[BCD_SIGN]=1;
+    CopyBCD_EtI(dest,TableBase(table)+i*MATH_ENTRY_SIZE);
+    return;
   }
-  else BCD[BCD_SIGN]=0;
-
-  BCD[BCD_LEN]=0;
-  BCD[BCD_DEC]=0;
 
-  while (text[text_ptr])
+  hot=hot_table+hot_offset[table][i];
+  zeros=*hot++;
+  dest[BCD_SIGN]=0;
+  dest[BCD_LEN]=hot_len;
+  dest[BCD_DEC]=2;
+  for (j=0;j<zeros;j++) dest[j+3]=0;
+  for (j=zeros;j<hot_len;j++)
   {
-    if (text[text_ptr]=='.')
-    {
-      BCD[BCD_DEC]=text_ptr;
-      found=1;
-    }
-    else
-    {
-      BCD[BCD_ptr]=text[text_ptr]-'0';
-      BCD_ptr++;
-    }
-    text_ptr++;
+    if ((j-zeros)&1) dest[j+3]=(*hot++)&0xF;
+    else dest[j+3]=(*hot)>>4;
   }
-  BCD[BCD_LEN]=text_ptr-found;
-  if (found==0) BCD[BCD_DEC]=BCD[BCD_LEN];
 }
 
 static void ImmedBCD_RAM(const char *text, unsigned char *BCD)
@@ -2661,13 +3284,14 @@ static void BufferBCD_ItI(const unsigned char *text, unsigned char *BCD)
   if (found==0) BCD[BCD_DEC]=BCD[BCD_LEN];
 }
 
+//External versions of the helpers move the number into ext_buff with one
+//block transfer and run the internal kernel. Templates would work since
+//this is built as C++ but a thin wrapper per helper is the same code and
+//reads like the rest of the file
 static bool IsZero(unsigned char *n1)
 {
-  #pragma MM_VAR n1
-  int i,i_end;
-  i_end=n1[BCD_LEN]+3;
-  for (i=3;i<i_end;i++) if (n1[i]!=0) return false;
-  return true;
+  CopyBCD_EtI(ext_buff,n1);
+  return IsZero_RAM(ext_buff);
 }
 
 static bool IsZero_RAM(unsigned char *n1)
@@ -2679,7 +3303,19 @@ static bool IsZero_RAM(unsigned char *n1)
   return true;
 }
 
+//result can be n1 or n2 so a+=b is AddBCD(a,a,b)
 static void AddBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2)
+{
+  SumBCD(result,n1,n2,0);
+}
+
+static void SubBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2)
+{
+  SumBCD(result,n1,n2,1);
+}
+
+//n1+n2 or n1-n2 when negate is set. Operands aren't touched
+static void SumBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2, unsigned char negate)
 {
   //#pragma MM_VAR result
   //#pragma MM_VAR n1
@@ -2694,49 +3330,29 @@ static void AddBCD(unsigned char *result, const unsigned char *n1, const unsigne
   int n1_whole=0, n2_whole=0;
   //where to start counting if decimal lengths are different
   int n1_dec=0, n2_dec=0;
-  //number to add when carrying. set to 9 for subtraction.
-  unsigned char carry_number=0;
-  bool subtracting=false;
+  //n2 is nine's complemented as it's added
+  unsigned char subtracting=0;
   int t1,t2,d1,d2;
+  //where both numbers have digits
+  int BCD_start, BCD_mid, i;
+  //result is written here. one digit over when the sum has a carry out
+  unsigned char *out;
 
   t1=n1[BCD_SIGN];
-  t2=n2[BCD_SIGN];
+  t2=n2[BCD_SIGN]^negate;
 
   if ((t1==0)&&(t2==0)) sign=0;
   else if ((t1==1)&&(t2==1)) sign=1;
   else sign=2;
 
+  //mixed signs subtract the negative one from the positive one
   if ((t1==1)&&(t2==0))
   {
     temp=n1;
     n1=n2;
     n2=temp;
   }
-
-  if ((n1[BCD_SIGN]==0)&&(n2[BCD_SIGN]==1))
-  {
-    buffer[BCD_DEC]=n2[BCD_DEC];
-    buffer[BCD_LEN]=n2[BCD_LEN];
-    carry=1;
-    for (BCD_ptr=n2[BCD_LEN]+2;BCD_ptr>=3;BCD_ptr--)
-    {
-      t1=9-n2[BCD_ptr]+carry;
-      if (t1==10) buffer[BCD_ptr]=0;
-      else
-      {
-        carry=0;
-        buffer[BCD_ptr]=t1;
-      }
-    }
-    carry_number=9;
-    if (carry==1)
-    {
-      //buffer[3]=0;
-      carry_number=0;
-    }
-    n2=buffer;
-    subtracting=true;
-  }
+  if (sign==2) subtracting=1;
 
   //make result whole part equal to the greater of operand whole parts + 1
   t1=n1[BCD_DEC];
@@ -2767,78 +3383,130 @@ static void AddBCD(unsigned char *result, const unsigned char *n1, const unsigne
     result[BCD_LEN]=result[BCD_DEC]+d2-t2;
   }
 
-  carry=0;
+  //one of each pair is 0 so add in parts instead of checking ranges for
+  //every digit. BCD_start to BCD_mid is where both numbers have digits
   BCD_end=result[BCD_LEN]+2;
-  for (BCD_ptr=BCD_end;BCD_ptr>=3;BCD_ptr--)
-  {
-    t1=carry;
-    if ((BCD_ptr<=BCD_end-n1_dec)&&(BCD_ptr>n1_whole+2)) t1+=n1[BCD_ptr-n1_whole];
-    if ((BCD_ptr<=BCD_end-n2_dec)&&(BCD_ptr>n2_whole+2)) t1+=n2[BCD_ptr-n2_whole];
-    if (BCD_ptr<=n2_whole+2) t1+=carry_number;
+  BCD_mid=BCD_end-n1_dec-n2_dec;
+  BCD_start=n1_whole+n2_whole+3;
 
-    if (t1>9)
+  //the first digits from the left that don't add up to 9 decide whether
+  //there is a carry out so room for it is left now instead of shifting after
+  out=result;
+  if (!subtracting)
+  {
+    for (BCD_ptr=3;BCD_ptr<=BCD_end;BCD_ptr++)
     {
-      t1-=10;
-      carry=1;
+      i=BCD_ptr-n1_whole;
+      t1=((i>=3)&&(i<d1+3))?n1[i]:0;
+      i=BCD_ptr-n2_whole;
+      if ((i>=3)&&(i<d2+3)) t1+=n2[i];
+      if (t1!=9) break;
     }
-    else carry=0;
-    result[BCD_ptr]=t1;
+    if ((BCD_ptr<=BCD_end)&&(t1>9)) out++;
+  }
+
+  //ten's complement is the nine's complement plus one
+  carry=subtracting;
+
+  //end of the longer decimal part. Only n1 there is a copy since the 9s
+  //and the 1 of the complemented zeros of n2 carry straight through
+  i=BCD_mid;
+  if (i<BCD_start-1) i=BCD_start-1;
+  if (n2_dec)
+  {
+    for (BCD_ptr=BCD_end;BCD_ptr>i;BCD_ptr--) out[BCD_ptr]=n1[BCD_ptr-n1_whole];
+  }
+  else carry=AddDigits(out+i+1,zero_digits,n2+i+1-n2_whole,BCD_end-i,subtracting,carry);
+
+  //both numbers
+  if (BCD_mid>=BCD_start)
+  {
+    carry=AddDigits(out+BCD_start,n1+BCD_start-n1_whole,n2+BCD_start-n2_whole,
+                    BCD_mid-BCD_start+1,subtracting,carry);
+    i=BCD_start-1;
+  }
+  else
+  {
+    //gap between the numbers when one ends before the other starts
+    carry=AddDigits(out+BCD_mid+1,zero_digits,zero_digits,i-BCD_mid,subtracting,carry);
+    i=BCD_mid;
   }
 
-  if ((carry==1)&&(subtracting==false))
+  //start of the longer whole part
+  if (n2_whole) carry=AddDigits(out+3,n1+3,zero_digits,i-2,subtracting,carry);
+  else carry=AddDigits(out+3,zero_digits,n2+3,i-2,subtracting,carry);
+
+  if (out!=result)
   {
-    PadBCD_RAM(result,1);
     result[3]=1;
+    result[BCD_LEN]+=1;
+    result[BCD_DEC]+=1;
   }
 
-  if ((carry==0)&&(carry_number==9)&&(sign==2))
+  //n2 was bigger so the difference is the ten's complement of the result
+  if ((carry==0)&&(sign==2))
   {
-    carry=1;
-    for (BCD_ptr=result[BCD_LEN]+2;BCD_ptr>=3;BCD_ptr--)
-    {
-      t1=9-result[BCD_ptr]+carry;
-      if (t1==10) t1=0;
-      else carry=0;
-      result[BCD_ptr]=t1;
-    }
+    AddDigits(result+3,zero_digits,result+3,result[BCD_LEN],1,1);
     sign=1;
   }
   else if (sign==2) sign=0;
   result[BCD_SIGN]=sign;
+  TrimBCD(result);
 }
 
-static void SubBCD(unsigned char *result, const unsigned char *n1, unsigned char *n2)
-{
-  //#pragma MM_VAR result
-  //#pragma MM_VAR n1
-  //#pragma MM_VAR n2
-  n2[BCD_SIGN]=!n2[BCD_SIGN];
-  AddBCD(result,n1,n2);
-  n2[BCD_SIGN]=!n2[BCD_SIGN];
-}
-
-static void PrintBCD(const unsigned char *BCD, int dec_point)
+//Adds count digits of a and b into out, right to left, four digits to a
+//32 bit word one digit per byte. Adding 246 to each byte carries into the
+//next byte exactly when the digits add up to 10 or more, then 246 is taken
+//back off the bytes that didn't carry. b is nine's complemented first when
+//complement is set. Returns the carry out
+static unsigned char AddDigits(unsigned char *out, const unsigned char *a, const unsigned char *b, int count, unsigned char complement, unsigned char carry)
 {
-  #pragma MM_VAR BCD
-  int BCD_ptr,BCD_end;
-  bool zero=true;
+  unsigned long wa,wb,sum,carries;
+  unsigned char t1;
 
-  BCD_end=BCD[BCD_LEN]+3;
-  if (dec_point>=0)
+  while (count>=4)
   {
-    if ((BCD[BCD_LEN]-BCD[BCD_DEC])>dec_point)
+    count-=4;
+    wa=((unsigned long)a[count]<<24)|((unsigned long)a[count+1]<<16)|(a[count+2]<<8)|a[count+3];
+    wb=((unsigned long)b[count]<<24)|((unsigned long)b[count+1]<<16)|(b[count+2]<<8)|b[count+3];
+    if (complement) wb=0x09090909-wb;
+    wb+=0xF6F6F6F6;
+    sum=(wa+wb)&0xFFFFFFFF;
+    carries=(sum<wa);
+    sum=(sum+carry)&0xFFFFFFFF;
+    if (sum<carry) carries=1;
+    carry=carries;
+    //bit 8 of each byte is the carry into it so shift down to the byte
+    //that made it. Top byte's carry is the carry out
+    carries=((sum^wa^wb)>>8)&0x010101;
+    carries|=(unsigned long)carry<<24;
+    sum-=(carries^0x01010101)*0xF6;
+    out[count]=sum>>24;
+    out[count+1]=sum>>16;
+    out[count+2]=sum>>8;
+    out[count+3]=sum;
+  }
+  while (count>0)
+  {
+    count--;
+    t1=b[count];
+    if (complement) t1=9-t1;
+    t1+=a[count]+carry;
+    if (t1>9)
     {
-      BCD_end=BCD[BCD_DEC]+dec_point+3;
+      t1-=10;
+      carry=1;
     }
+    else carry=0;
+    out[count]=t1;
   }
+  return carry;
+}
 
-  if (BCD[BCD_SIGN]==1) putchar('-');
-  for (BCD_ptr=3;BCD_ptr<BCD_end;BCD_ptr++)
-  {
-    if (BCD_ptr==BCD[BCD_DEC]+3) putchar('.');
-    if (BCD[BCD_ptr]>9) putchar('x');
-    else putchar('0'+BCD[BCD_ptr]);
-  }
+static void PrintBCD(const unsigned char *BCD, int dec_point)
+{
+  CopyBCD_EtI(ext_buff,(unsigned char *)BCD);
+  PrintBCD_RAM(ext_buff,dec_point);
 }
 
 static void PrintBCD_RAM(const unsigned char *BCD, int dec_point)
@@ -2870,300 +3538,443 @@ static void MultBCD(unsigned char *result, const unsigned char *n1, const unsign
   //#pragma MM_VAR result
   //#pragma MM_VAR n1
   //#pragma MM_VAR n2
-  //#pragma MM_VAR temp
 
-  //#pragma MM_DECLARE
-    unsigned char temp[5];
-  //#pragma MM_END
-
-  unsigned char i,j,k,flip=0;
-  unsigned char i_end, j_end, k_end;
-  //maybe b1,b2 is faster
-  unsigned char b0,b1;
-  CopyBCD_ItI(result,perm_zero);
-  CopyBCD_ItI(perm_buff1,perm_zero);
-
-  temp[BCD_SIGN]=0;
-  temp[BCD_LEN]=2;
+  int i;
+  unsigned char i_end, j_end;
+  unsigned short a[LIMBS],b[LIMBS],prod[2*LIMBS];
+  int a_len,b_len,k,ptr;
 
   i_end=n1[BCD_LEN];
   j_end=n2[BCD_LEN];
-  for (i=0;i<i_end;i++)
+  if ((i_end==0)||(j_end==0)) CopyBCD_ItI(result,perm_zero);
+  else
   {
-    for (j=0;j<j_end;j++)
+    a_len=ToLimbs(a,n1,i_end);
+    if (n1==n2)
     {
-      b0=0;
-      b1=0;
-      k_end=n1[i+3];
-      for (k=0;k<k_end;k++) b0+=n2[j+3];
-      while (b0>9)
-      {
-        b1+=1;
-        b0-=10;
-      }
-      temp[3]=b1;
-      temp[4]=b0;
-
-      temp[BCD_DEC]=2+i_end-i+j_end-j-2;
-      if (flip==0) AddBCD(result,temp,perm_buff1);
-      else AddBCD(perm_buff1,temp,result);
-      flip=!flip;
+      //squaring
+      b_len=a_len;
+      LimbSquare(prod,a,a_len);
     }
-  }
-
-  if (flip==0)
-  {
-    //Just CopyBCD?
-    i=perm_buff1[BCD_LEN];
-    for (j=0;j<i+3;j++) result[j]=perm_buff1[j];
-  }
-  i=(i_end-n1[BCD_DEC])+(j_end-n2[BCD_DEC]);
-
-  if (i>Settings.DecPlaces)
-  {
-    result[BCD_LEN]-=(i-Settings.DecPlaces-1);
-    result[BCD_DEC]=result[BCD_LEN];
-
-    if (result[result[BCD_LEN]+2]>4)
+    else
     {
-      ImmedBCD_RAM("10",temp);
-      AddBCD(perm_buff1,result,temp);
-      CopyBCD_ItI(result,perm_buff1);
+      b_len=ToLimbs(b,n2,j_end);
+      LimbMult(prod,a,a_len,b,b_len);
     }
-    result[BCD_LEN]-=1;
-    i=Settings.DecPlaces+1;
+
+    //whole number product
+    result[BCD_SIGN]=0;
+    result[BCD_LEN]=i_end+j_end;
+    result[BCD_DEC]=i_end+j_end;
+    ptr=i_end+j_end+2;
+    for (k=0;k<(a_len+b_len);k++) ptr=FromLimb(result,ptr,prod[k]);
   }
+  i=(i_end-n1[BCD_DEC])+(j_end-n2[BCD_DEC]);
   result[BCD_DEC]-=i;
   result[BCD_SIGN]=n1[BCD_SIGN]^n2[BCD_SIGN];
+  TrimBCD(result);
 
   FullShrinkBCD_RAM(result);
 }
 
+//result=n1*n1. MultBCD spots the shared operand and adds each cross product
+//once, doubled, so it's about half the work of a general multiply
+static void SquareBCD(unsigned char *result, const unsigned char *n1)
+{
+  MultBCD(result,n1,n1);
+}
+
 static void DivBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2)
 {
   //#pragma MM_VAR result
   //#pragma MM_VAR n1
   //#pragma MM_VAR n2
 
-  int i,j;
-  int i_end, j_end;
-  int result_ptr,n1_ptr;
-  int max_offset,dec_offset=0;
-  int post_offset=0, pre_offset=0;
-  unsigned char remainder=0, res_ptr_off=0;
-  bool logic;
-
-  max_offset=n1[BCD_LEN]-n1[BCD_DEC];
-  if ((n2[BCD_LEN]-n2[BCD_DEC])>max_offset) max_offset=n2[BCD_LEN]-n2[BCD_DEC];
-  if (Settings.DecPlaces>max_offset) max_offset=Settings.DecPlaces;
-
-  //result[BCD_SIGN]=0;
-  result[BCD_LEN]=0;
+  unsigned short rem[LIMBS+1],div[LIMBS];
+  int i,j,l,top,div_len;
+  int places,digits,lead,skip;
+  unsigned long q,r_hi,d_hi;
 
-  result_ptr=3;
-
-  post_offset=n1[BCD_LEN]-n2[BCD_LEN];
-
-  if ((n1[BCD_DEC]-n2[BCD_DEC]+1)<post_offset)
-  {
-    pre_offset=-1*(n1[BCD_DEC]-n2[BCD_DEC]+1);
-    post_offset=0;
-    if (pre_offset<0)
-    {
-      result[BCD_DEC]=-pre_offset;
-    }
-    else
-    {
-      result[BCD_DEC]=0;
-      result_ptr+=pre_offset;
-      res_ptr_off+=pre_offset;
-      for (i=3;i<(pre_offset+3);i++) result[i]=0;
-    }
-  }
-  else if (post_offset>0)
+  div_len=ToLimbs(div,n2,n2[BCD_LEN]);
+  while ((div_len>0)&&(div[div_len-1]==0)) div_len--;
+  if (div_len==0)
   {
-    post_offset=0;
-    result[BCD_DEC]=n1[BCD_DEC]-n2[BCD_DEC]+1;
+    CopyBCD_ItI(result,perm_zero);
+    return;
   }
-  else
+  top=div_len-1;
+
+  //as many decimals as WorkPlaces or either number. Cut there, not rounded
+  places=Settings.WorkPlaces;
+  if ((n1[BCD_LEN]-n1[BCD_DEC])>places) places=n1[BCD_LEN]-n1[BCD_DEC];
+  if ((n2[BCD_LEN]-n2[BCD_DEC])>places) places=n2[BCD_LEN]-n2[BCD_DEC];
+
+  //digits of n1 shifted so the quotient of the whole numbers has places
+  //decimals, with zeros in front to make at least one whole digit
+  digits=n1[BCD_DEC]+places+n2[BCD_LEN]-n2[BCD_DEC];
+
+  //quotient digits are 0 until n1 has brought in one less digit than n2
+  //has significant digits so they aren't stored
+  for (skip=0;(skip<n2[BCD_LEN])&&(n2[skip+3]==0);skip++);
+  skip=n2[BCD_LEN]-skip-1;
+
+  //fewer places if the quotient still wouldn't fit in a cell
+  i=digits-skip-(MATH_CELL_SIZE-3);
+  if (i>places) i=places;
+  if (i>0)
   {
-    post_offset*=-1;
-    result[BCD_DEC]=post_offset+n1[BCD_DEC]-n2[BCD_DEC]+1;
+    places-=i;
+    digits-=i;
   }
 
-  perm_buff2[BCD_SIGN]=1;
-  perm_buff2[BCD_LEN]=n2[BCD_LEN];
-  perm_buff2[BCD_DEC]=n2[BCD_LEN];
-
-  perm_buff1[BCD_SIGN]=0;
-  perm_buff1[BCD_LEN]=n2[BCD_LEN]+1;
-  perm_buff1[BCD_DEC]=perm_buff1[BCD_LEN];
-  perm_buff1[3]=0;
-
-  i_end=n2[BCD_LEN]+3;
-  for (i=3;i<i_end;i++)
+  lead=0;
+  if (digits<(places+1))
   {
-    //<=? was <
-    if ((i-3)<post_offset) perm_buff1[i+1]=0;
-    else if ((i-post_offset)>(n1[BCD_LEN]+2)) perm_buff1[i+1]=0;
-    else perm_buff1[i+1]=n1[i-post_offset];
-    perm_buff2[i]=n2[i];
+    lead=places+1-digits;
+    digits=places+1;
   }
-
-  n1_ptr=n2[BCD_LEN]+3+post_offset;
-  do
+  if (skip>(digits-places-1)) skip=digits-places-1;
+  //whole part too big for a cell. Only has to stay inside it
+  if ((digits-skip)>(MATH_CELL_SIZE-3)) digits=skip+MATH_CELL_SIZE-3;
+
+  //long division one decimal digit at a time on a base 10000 remainder.
+  //Top two limbs give a guess at most one too small
+  for (l=0;l<=div_len;l++) rem[l]=0;
+  d_hi=div[top]*(unsigned long)LIMB_BASE;
+  if (top>0) d_hi+=div[top-1];
+  for (i=0;i<digits;i++)
   {
-    result[result_ptr]=0;
-    result[BCD_LEN]+=1;
-
-    do
-    {
-      AddBCD(perm_buff3,perm_buff1,perm_buff2);
-
-      if ((perm_buff3[BCD_SIGN]==0)||(IsZero_RAM(perm_buff3)))
-      {
-        result[result_ptr]+=1;
-        if (result[result_ptr]==10)
-        {
-          result[result_ptr]=0;
-          for (i=result_ptr-1;i>=3;i--)
-          {
-            result[i]+=1;
-            if (result[i]<10) break;
-            else result[i]=0;
-          }
-          if (i==2)
-          {
-            result[3]=1;
-            for (i=4;i<result_ptr;i++) result[i]=0;
-            result_ptr++;
-            result[BCD_LEN]+=1;
-            result[BCD_DEC]+=1;
-            result[result_ptr]=0;
-          }
-        }
-        i_end=perm_buff1[BCD_LEN]+3;
-        for (i=3;i<i_end;i++) perm_buff1[i]=perm_buff3[i];
-      }
-    } while ((perm_buff3[BCD_SIGN]==0)&&(!IsZero_RAM(perm_buff3)));
-
-    i_end=n2[BCD_LEN]+3;
-    for (i=3;i<i_end;i++) perm_buff1[i]=perm_buff1[i+1];
-
-    if ((n1_ptr-3)>=n1[BCD_LEN])
-    {
-      perm_buff1[i]=0;
-    }
-    else
-    {
-      perm_buff1[i]=n1[n1_ptr];
-      n1_ptr++;
-    }
-    result_ptr++;
-
-    //< or <=?
-    if ((result_ptr-3)<(result[BCD_DEC]))
-    {
-      logic=true;
-    }
-    else if (((result[BCD_LEN]-result[BCD_DEC])<(max_offset+1)))//&&(!IsZero(div_buff1)))
+    j=i-lead;
+    if ((j>=0)&&(j<n1[BCD_LEN])) q=n1[j+3];
+    else q=0;
+    for (l=0;l<=div_len;l++)
     {
-      logic=true;
+      q+=rem[l]*10UL;
+      rem[l]=q%LIMB_BASE;
+      q/=LIMB_BASE;
     }
-    else logic=false;
-  } while (logic);
 
-  if ((result[BCD_LEN]-result[BCD_DEC])>max_offset)
-  {
-    if (result[result[BCD_LEN]+2]>4)
+    r_hi=rem[top+1]*(unsigned long)LIMB_BASE+rem[top];
+    r_hi*=LIMB_BASE;
+    if (top>0) r_hi+=rem[top-1];
+    q=r_hi/(d_hi+1);
+    if (q) LimbSub(rem,div,div_len,q);
+    while (LimbComp(rem,div,div_len))
     {
-      i_end=result[BCD_LEN]+2;
-      for (i=3;i<i_end;i++) perm_buff3[i]=result[i];
-      i=result[BCD_LEN];
-      j=result[BCD_DEC];
-      perm_buff3[BCD_SIGN]=0;
-      perm_buff3[BCD_LEN]=result[BCD_LEN]-1;
-      perm_buff3[BCD_DEC]=perm_buff3[BCD_LEN];
-      perm_buff1[BCD_SIGN]=0;
-      perm_buff1[BCD_LEN]=1;
-      perm_buff1[BCD_DEC]=1;
-      perm_buff1[3]=1;
-      AddBCD(result,perm_buff3,perm_buff1);
-      result[BCD_DEC]=j;
-      if (result[BCD_LEN]==i) result[BCD_DEC]+=1;
+      LimbSub(rem,div,div_len,1);
+      q++;
     }
-    else
+    if (i>=skip) result[i-skip+3]=q;
+    //interrupted results only need to be well formed
+    if (IdleAbort())
     {
-      result[BCD_LEN]-=1;
+      for (i++;i<digits;i++) if (i>=skip) result[i-skip+3]=0;
     }
   }
+
+  result[BCD_LEN]=digits-skip;
+  result[BCD_DEC]=digits-skip-places;
   result[BCD_SIGN]=n1[BCD_SIGN]^n2[BCD_SIGN];
   FullShrinkBCD_RAM(result);
+  TrimBCD(result);
 }
 
-static void ShrinkBCD(unsigned char *dest,unsigned char *src)
+//rem-=div*amount. rem has one more limb than div
+static void LimbSub(unsigned short *rem, const unsigned short *div, int div_len, unsigned long amount)
 {
-  #pragma MM_VAR dest
-  #pragma MM_VAR src
-
-  int BCD_ptr,off_ptr=0;
-  int ptr_end;
-  if ((src[3]==0)&&(src[BCD_DEC]!=0)&&(src[BCD_LEN]>1)) off_ptr=1;
-  ptr_end=src[BCD_LEN]+3-off_ptr;
-  for (BCD_ptr=3;BCD_ptr<ptr_end;BCD_ptr++) dest[BCD_ptr]=src[BCD_ptr+off_ptr];
-  dest[BCD_SIGN]=src[BCD_SIGN];
-  dest[BCD_LEN]=src[BCD_LEN];
-  dest[BCD_DEC]=src[BCD_DEC];
-  if (off_ptr==1)
+  int l;
+  unsigned long borrow=0,sub;
+  for (l=0;l<=div_len;l++)
   {
-    dest[BCD_LEN]-=1;
-    dest[BCD_DEC]-=1;
+    sub=borrow;
+    if (l<div_len) sub+=div[l]*amount;
+    borrow=sub/LIMB_BASE;
+    sub%=LIMB_BASE;
+    if (rem[l]<sub)
+    {
+      rem[l]+=LIMB_BASE-sub;
+      borrow++;
+    }
+    else rem[l]-=sub;
   }
 }
 
-static void ShrinkBCD_RAM(unsigned char *dest,unsigned char *src)
+//Schoolbook product of limbs one column at a time from the right.
+//prod gets a_len+b_len limbs
+static void LimbMult(unsigned short *prod, const unsigned short *a, int a_len, const unsigned short *b, int b_len)
 {
-  //#pragma MM_VAR dest
-  //#pragma MM_VAR src
+  int k,l,l_end;
+  unsigned long column=0;
 
-  int BCD_ptr,off_ptr=0;
-  int ptr_end;
-  if ((src[3]==0)&&(src[BCD_DEC]!=0)&&(src[BCD_LEN]>1)) off_ptr=1;
-  ptr_end=src[BCD_LEN]+3-off_ptr;
-  for (BCD_ptr=3;BCD_ptr<ptr_end;BCD_ptr++) dest[BCD_ptr]=src[BCD_ptr+off_ptr];
-  dest[BCD_SIGN]=src[BCD_SIGN];
-  dest[BCD_LEN]=src[BCD_LEN];
-  dest[BCD_DEC]=src[BCD_DEC];
-  if (off_ptr==1)
+  for (k=0;k<(a_len+b_len);k++)
   {
-    dest[BCD_LEN]-=1;
-    dest[BCD_DEC]-=1;
+    l=0;
+    if (k>=b_len) l=k-b_len+1;
+    l_end=k+1;
+    if (l_end>a_len) l_end=a_len;
+    for (;l<l_end;l++) column+=(unsigned long)a[l]*b[k-l];
+    prod[k]=column%LIMB_BASE;
+    column/=LIMB_BASE;
   }
 }
 
-static void FullShrinkBCD(unsigned char *n1)
+//Square of n limbs into 2n limbs of prod. Each cross product a[l]*a[k-l] is
+//added once and doubled
+static void LimbSquare(unsigned short *prod, const unsigned short *a, int n)
 {
-  #pragma MM_VAR n1
-  while ((n1[3]==0)&&(n1[BCD_DEC]>1)) ShrinkBCD(n1,n1);
-}
+  int k,l,l_end;
+  unsigned long column=0,cross;
 
-static void FullShrinkBCD_RAM(unsigned char *n1)
-{
-  //#pragma MM_VAR n1
-  while ((n1[3]==0)&&(n1[BCD_DEC]>1))
+  for (k=0;k<(2*n);k++)
   {
-    ShrinkBCD_RAM(n1,n1);
+    l=0;
+    if (k>=n) l=k-n+1;
+    l_end=(k+1)/2;
+    cross=0;
+    for (;l<l_end;l++) cross+=(unsigned long)a[l]*a[k-l];
+    column+=cross+cross;
+    if ((k&1)==0) column+=(unsigned long)a[k/2]*a[k/2];
+    prod[k]=column%LIMB_BASE;
+    column/=LIMB_BASE;
   }
 }
 
-static void PadBCD(unsigned char *n1, int amount)
+//true if rem>=div
+static bool LimbComp(const unsigned short *rem, const unsigned short *div, int div_len)
 {
-  #pragma MM_VAR n1
-  int i;
-  for (i=n1[BCD_LEN]+3;i>=3;i--) n1[i+amount]=n1[i];
-  for (i=3;i<(amount+3);i++) n1[i]=0;
-  n1[BCD_LEN]+=amount;
-  n1[BCD_DEC]+=amount;
+  int l;
+  if (rem[div_len]) return true;
+  for (l=div_len-1;l>=0;l--)
+  {
+    if (rem[l]!=div[l]) return rem[l]>div[l];
+  }
+  return true;
+}
+
+//Splits the count digits of n1 into base 10000 limbs, lowest limb first
+static int ToLimbs(unsigned short *limbs, const unsigned char *n1, int count)
+{
+  int i,i_end,limb_count=0;
+  unsigned int limb;
+
+  for (i_end=count+3;i_end>3;i_end-=LIMB_DIGITS)
+  {
+    limb=0;
+    i=i_end-LIMB_DIGITS;
+    if (i<3) i=3;
+    for (;i<i_end;i++) limb=limb*10+n1[i];
+    limbs[limb_count++]=limb;
+  }
+  return limb_count;
+}
+
+//Writes the digits of limb from result[ptr] back, stopping at the first
+//digit. Returns where the next limb goes
+static int FromLimb(unsigned char *result, int ptr, unsigned int limb)
+{
+  int i;
+  for (i=0;(i<LIMB_DIGITS)&&(ptr>=3);i++)
+  {
+    result[ptr--]=limb%10;
+    limb/=10;
+  }
+  return ptr;
+}
+
+//Reads n1 as a whole number and a count of decimal places. False if it has
+//more than SHORT_DIGITS digits after its leading zeros
+static bool ShortBCD(const unsigned char *n1, unsigned long long *value, int *scale)
+{
+  int i,i_end;
+  unsigned long long total=0;
+
+  if (n1[BCD_DEC]>n1[BCD_LEN]) return false;
+  i_end=n1[BCD_LEN]+3;
+  for (i=3;i<i_end;i++) if (n1[i]) break;
+  if ((i_end-i)>SHORT_DIGITS) return false;
+  for (;i<i_end;i++) total=total*10+n1[i];
+  *value=total;
+  *scale=n1[BCD_LEN]-n1[BCD_DEC];
+  return true;
+}
+
+//Writes value with scale decimal places and at least one whole digit
+static void ShortToBCD(unsigned char *result, unsigned long long value, int scale, unsigned char sign)
+{
+  int i,len;
+
+  len=ShortDigits(value);
+  if (len<(scale+1)) len=scale+1;
+  result[BCD_SIGN]=sign;
+  result[BCD_LEN]=len;
+  result[BCD_DEC]=len-scale;
+  for (i=len+2;i>=3;i--)
+  {
+    result[i]=value%10;
+    value/=10;
+  }
+}
+
+static int ShortDigits(unsigned long long value)
+{
+  int digits=1;
+  while (value>9)
+  {
+    value/=10;
+    digits++;
+  }
+  return digits;
+}
+
+//+ - and * with the same result as AddBCD, SubBCD and MultBCD once the
+//result is committed. False if either number is too long or the result
+//might not fit so the caller falls back to the BCD version
+static bool ShortMathBCD(unsigned char op, unsigned char *result, const unsigned char *n1, const unsigned char *n2)
+{
+  unsigned long long a,b;
+  int sa,sb,s,i;
+  unsigned char sign1,sign2;
+
+  if (!ShortBCD(n1,&a,&sa)) return false;
+  if (!ShortBCD(n2,&b,&sb)) return false;
+  sign1=n1[BCD_SIGN];
+  sign2=n2[BCD_SIGN];
+
+  if (op=='*')
+  {
+    if ((b!=0)&&(a>(SHORT_MAX/b))) return false;
+    a*=b;
+    s=sa+sb;
+    //cut to WorkPlaces like MultBCD
+    for (;s>Settings.WorkPlaces;s--) a/=10;
+    ShortToBCD(result,a,s,sign1^sign2);
+    return true;
+  }
+
+  if (op=='-') sign2=!sign2;
+  s=sa;
+  if (sb>s) s=sb;
+  if ((ShortDigits(a)+s-sa)>SHORT_DIGITS) return false;
+  if ((ShortDigits(b)+s-sb)>SHORT_DIGITS) return false;
+  for (i=sa;i<s;i++) a*=10;
+  for (i=sb;i<s;i++) b*=10;
+  if (sign1==sign2) a+=b;
+  else if (a>=b) a-=b;
+  else
+  {
+    a=b-a;
+    sign1=sign2;
+  }
+  //cut to WorkPlaces like AddBCD
+  for (;s>Settings.WorkPlaces;s--) a/=10;
+  ShortToBCD(result,a,s,sign1);
+  return true;
+}
+
+//Same result as DivBCD. n1/n2 is the quotient of the two whole numbers with
+//the point moved by the difference in decimal places, so the digits come
+//from long division on the remainder
+static bool ShortDivBCD(unsigned char *result, const unsigned char *n1, const unsigned char *n2)
+{
+  unsigned long long a,b,q;
+  int sa,sb,places,zeros,len_q,i,i_end;
+
+  if (!ShortBCD(n1,&a,&sa)) return false;
+  if (!ShortBCD(n2,&b,&sb)) return false;
+  if (b==0) return false;
+
+  //DivBCD keeps the most decimals of WorkPlaces and both numbers
+  places=Settings.WorkPlaces;
+  if (sa>places) places=sa;
+  if (sb>places) places=sb;
+
+  q=a/b;
+  a%=b;
+  len_q=ShortDigits(q);
+  //zeros in front when the point is left of q so there's a whole digit
+  zeros=1;
+  if ((sa-sb-len_q)>0) zeros+=sa-sb-len_q;
+  i_end=zeros+len_q+places+sb-sa;
+  if ((i_end+3)>MATH_CELL_SIZE) return false;
+
+  for (i=zeros+len_q+2;i>=3;i--)
+  {
+    result[i]=q%10;
+    q/=10;
+  }
+  i_end+=3;
+  for (i=zeros+len_q+3;i<i_end;i++)
+  {
+    a*=10;
+    result[i]=a/b;
+    a%=b;
+  }
+
+  result[BCD_LEN]=i_end-3;
+  result[BCD_DEC]=result[BCD_LEN]-places;
+  result[BCD_SIGN]=n1[BCD_SIGN]^n2[BCD_SIGN];
+  FullShrinkBCD_RAM(result);
+  TrimBCD(result);
+  return true;
+}
+
+//Leading zeros are counted first so the digits only move once. One whole
+//digit is always left
+static void FullShrinkBCD_RAM(unsigned char *n1)
+{
+  //#pragma MM_VAR n1
+  int i,i_end,zeros;
+
+  i_end=n1[BCD_LEN];
+  if (n1[BCD_DEC]<i_end) i_end=n1[BCD_DEC];
+  i_end--;
+  for (zeros=0;zeros<i_end;zeros++) if (n1[zeros+3]) break;
+  if (zeros==0) return;
+
+  i_end=n1[BCD_LEN]+3-zeros;
+  for (i=3;i<i_end;i++) n1[i]=n1[i+zeros];
+  n1[BCD_LEN]-=zeros;
+  n1[BCD_DEC]-=zeros;
+}
+
+//Only place numbers are normalized. Everything on BCD_stack has exactly one
+//whole digit if the whole part is 0 and no negative zero so DrawStack and
+//the next calculation don't need to fix them up
+static void CommitBCD(unsigned char *cell, unsigned char *n1)
+{
+  FullShrinkBCD_RAM(n1);
+  if (n1[BCD_DEC]==0) PadBCD_RAM(n1,1);
+  if (IsZero_RAM(n1)) n1[BCD_SIGN]=0;
+  CopyBCD_ItE(cell,n1);
+}
+
+//Every kernel cuts its result to WorkPlaces decimals so lengths stay bounded
+//in the loops. Cutting instead of rounding means the one round on commit
+//gives the same digits as rounding the exact result would
+static void TrimBCD(unsigned char *n1)
+{
+  //#pragma MM_VAR n1
+  if ((n1[BCD_LEN]-n1[BCD_DEC])>Settings.WorkPlaces) n1[BCD_LEN]=n1[BCD_DEC]+Settings.WorkPlaces;
+}
+
+//Rounds half up to places decimals
+static void RoundBCD(unsigned char *n1, int places)
+{
+  //#pragma MM_VAR n1
+  int i;
+
+  if ((n1[BCD_LEN]-n1[BCD_DEC])<=places) return;
+  n1[BCD_LEN]=n1[BCD_DEC]+places;
+  i=n1[BCD_LEN]+3;
+  if (n1[i]<5) return;
+  for (i--;(i>=3)&&(n1[i]==9);i--) n1[i]=0;
+  if (i>=3) n1[i]++;
+  else
+  {
+    //all 9s so the carry needs a new digit
+    PadBCD_RAM(n1,1);
+    n1[3]=1;
+  }
 }
 
 static void PadBCD_RAM(unsigned char *n1, int amount)
@@ -3179,29 +3990,30 @@ static void PadBCD_RAM(unsigned char *n1, int amount)
 //see if using this in other places makes things smaller
 static void CopyBCD(unsigned char *dest, unsigned char *src)
 {
-  #pragma MM_VAR dest
-  #pragma MM_VAR src
-  int i,i_end;
-  i_end=src[BCD_LEN]+3;
-  for (i=0;i<i_end;i++) dest[i]=src[i];
+  unsigned char chunk[RAM_CHUNK];
+  int i,i_end,count;
+  if ((dest>=BCD_stack)&&(dest<BCD_stack+STACK_SIZE*MATH_CELL_SIZE)) DrawDirty((dest-BCD_stack)/MATH_CELL_SIZE);
+  RAM_ReadBlock(chunk,src,3);
+  i_end=chunk[BCD_LEN]+3;
+  for (i=0;i<i_end;i+=count)
+  {
+    count=i_end-i;
+    if (count>RAM_CHUNK) count=RAM_CHUNK;
+    RAM_ReadBlock(chunk,src+i,count);
+    RAM_WriteBlock(dest+i,chunk,count);
+  }
 }
 
 static void CopyBCD_EtI(unsigned char *dest, unsigned char *src)
 {
-  //#pragma MM_VAR dest
-  #pragma MM_VAR src
-  int i,i_end;
-  i_end=src[BCD_LEN]+3;
-  for (i=0;i<i_end;i++) dest[i]=src[i];
+  RAM_ReadBlock(dest,src,3);
+  RAM_ReadBlock(dest+3,src+3,dest[BCD_LEN]);
 }
 
 static void CopyBCD_ItE(unsigned char *dest, unsigned char *src)
 {
-  #pragma MM_VAR dest
-  //#pragma MM_VAR src
-  int i,i_end;
-  i_end=src[BCD_LEN]+3;
-  for (i=0;i<i_end;i++) dest[i]=src[i];
+  if ((dest>=BCD_stack)&&(dest<BCD_stack+STACK_SIZE*MATH_CELL_SIZE)) DrawDirty((dest-BCD_stack)/MATH_CELL_SIZE);
+  RAM_WriteBlock(dest,src,src[BCD_LEN]+3);
 }
 
 static void CopyBCD_ItI(unsigned char *dest, unsigned char *src)
@@ -3225,6 +4037,11 @@ static bool LnBCD(unsigned char *result, unsigned char *arg)
 
   bool flip_sign=false;
   unsigned int i,j=1,k=0;
+  //x is the argument being worked down to 1. next is the trial value and
+  //they swap when it's kept instead of copying
+  unsigned char *x=p1,*next=p0,*swap;
+
+  if (CacheLookup(CACHE_LN,arg,0,result,0)) return true;
 
   ImmedBCD_RAM("1",temp);
 
@@ -3247,8 +4064,7 @@ static bool LnBCD(unsigned char *result, unsigned char *arg)
 
   for (i=0;i<8;i++)
   {
-    RorBCD(p0,p1,j);
-    CopyBCD_ItI(p1,p0);
+    RorBCD(p1,p1,j);
     SubBCD(p0,p1,temp);
     if (p0[BCD_SIGN]==1) break;
     j=1<<(k++);
@@ -3259,36 +4075,37 @@ static bool LnBCD(unsigned char *result, unsigned char *arg)
 
   j=1<<i;
   k=7-k;
-  CopyBCD_EtI(result,logs+k*MATH_ENTRY_SIZE);
+  TableEntry(result,TABLE_LOG,k);
 
   for (i=k;i<Settings.LogTableSize;i++)
   {
+    if (IdleAbort()) break;
     if (j!=0)
     {
-      RolBCD(p0,p1,j);
-      SubBCD(p2,p0,temp);
+      RolBCD(next,x,j);
+      SubBCD(p2,next,temp);
       j>>=1;
     }
     else
     {
-      RorBCD(p2,p1,i-7);
-      AddBCD(p0,p1,p2);
-      SubBCD(p2,p0,temp);
+      RorBCD(p2,x,i-7);
+      AddBCD(next,x,p2);
+      SubBCD(p2,next,temp);
     }
     if (p2[BCD_SIGN]==1)
     {
-      CopyBCD_ItI(p1,p0);
-      //temp for SubBCD
-      CopyBCD_EtI(p0,logs+i*MATH_ENTRY_SIZE);
-      //SubBCD(p2,result,logs+i*MATH_ENTRY_SIZE);
-      SubBCD(p2,result,p0);
-      CopyBCD_ItI(result,p2);
+      swap=x;
+      x=next;
+      next=swap;
+      //old x is free for the table entry
+      TableEntry(next,TABLE_LOG,i);
+      SubBCD(result,result,next);
     }
   }
-  SubBCD(p2,temp,p1);
-  SubBCD(p0,result,p2);
-  CopyBCD_ItI(result,p0);
+  SubBCD(p2,temp,x);
+  SubBCD(result,result,p2);
   if (flip_sign) result[BCD_SIGN]=1;
+  CacheStore(CACHE_LN,arg,0,result,0);
   return true;
 }
 
@@ -3304,13 +4121,14 @@ static void ExpBCD(unsigned char *result, unsigned char *arg)
   //#pragma MM_END
 
   unsigned int i,j=128;
-  unsigned int log_ptr=0;
-  bool invert=false;
-  if (arg[BCD_SIGN]==1)
-  {
-    invert=true;
-    arg[BCD_SIGN]=0;
-  }
+  bool invert;
+  //what's left of the argument. next takes it less an entry that fits and
+  //they swap instead of copying
+  unsigned char *rem=p0,*next=p1,*swap;
+
+  if (CacheLookup(CACHE_EXP,arg,0,result,0)) return;
+
+  invert=(arg[BCD_SIGN]==1);
 
   /*if (CompVarBCD(perm_zero,arg)==COMP_EQ)
   {
@@ -3325,36 +4143,36 @@ static void ExpBCD(unsigned char *result, unsigned char *arg)
   }
 
   ImmedBCD_RAM("1",temp);
-  CopyBCD_ItI(p0,arg);
+  CopyBCD_ItI(rem,arg);
+  rem[BCD_SIGN]=0;
   CopyBCD_ItI(result,temp);//stack_buffer
   for (i=0;i<Settings.LogTableSize;i++)
   {
-    CopyBCD_EtI(perm_buff1,logs+log_ptr);
-    //SubBCD(p1,p0,logs+log_ptr);
-    SubBCD(p1,p0,perm_buff1);
-    if (p1[BCD_SIGN]==0)
+    if (IdleAbort()) break;
+    TableEntry(perm_buff1,TABLE_LOG,i);
+    if (CompVarBCD_ItI(rem,perm_buff1)!=COMP_LT)
     {
-      CopyBCD_ItI(p0,p1);
-      if (i<8)
-      {
-        RolBCD(p1,result,j);
-      }
+      SubBCD(next,rem,perm_buff1);
+      swap=rem;
+      rem=next;
+      next=swap;
+      if (i<8) RolBCD(result,result,j);
       else
       {
         RorBCD(p2,result,i-7);
-        AddBCD(p1,result,p2);
+        AddBCD(result,result,p2);
       }
-      CopyBCD_ItI(result,p1);
     }
     j>>=1;
-    log_ptr+=MATH_ENTRY_SIZE;
   }
-  AddBCD(p1,p0,temp);
+  AddBCD(p1,rem,temp);
   MultBCD(p2,p1,result);
   CopyBCD_ItI(p2,result);
 
   if (invert) DivBCD(result,temp,p2);
   else CopyBCD_ItI(result,p2);
+
+  CacheStore(CACHE_EXP,arg,0,result,0);
 }
 
 static void RolBCD(unsigned char *result, unsigned char *arg, unsigned char amount)
@@ -3362,12 +4180,14 @@ static void RolBCD(unsigned char *result, unsigned char *arg, unsigned char amou
   //#pragma MM_VAR result
   //#pragma MM_VAR arg
 
-  int i,i_end,j;
+  int i,i_end,j,shift;
   unsigned char b0,b1;
 
   CopyBCD_ItI(result,arg);
   for (j=0;j<amount;j++)
   {
+    //top digit of 5 or more carries out so digits move over one as they go
+    shift=(result[3]>4);
     b1=0;
     i_end=result[BCD_LEN]+2;
     for (i=i_end;i>=3;i--)
@@ -3375,133 +4195,100 @@ static void RolBCD(unsigned char *result, unsigned char *arg, unsigned char amou
       b0=(result[i]<<1)+b1;
       if (b0>9) b0+=6;
       b1=b0>>4;
-      result[i]=(b0&0xF);
+      result[i+shift]=(b0&0xF);
     }
-    if (b1)
+    if (shift)
     {
-      PadBCD_RAM(result,1);
       result[3]=1;
+      result[BCD_LEN]+=1;
+      result[BCD_DEC]+=1;
     }
   }
 }
 
-//Does shifting one bit add an extra 0?
+//Divides by 2^amount. Same result as halving one bit at a time and cutting
+//to DecPlaces after every 4 bits but done as long division by up to 2^28
+//so only a few passes are needed at any precision
+#define ROR_CHUNK 28
 static void RorBCD(unsigned char *result, unsigned char *arg, unsigned char amount)
 {
   //#pragma MM_VAR result
   //#pragma MM_VAR arg
 
-  int i,i_end,j;
-  unsigned char b0,b1,b2;
-  unsigned char t1;
+  int i,i_end,k;
+  int whole,decs,fours,dec_out,places,keep;
+  unsigned long rem,cur,mask;
+  bool lost=false;
+
+  CopyBCD_ItI(result,arg);
+  if (amount==0) return;
 
-  static const unsigned char table[]={
-  0,0,0,0, // 0/16
-  0,6,2,5, // 1/16
-  1,2,5,0, // 2/16
-  1,8,7,5, // 3/16
-  2,5,0,0, // 4/16
-  3,1,2,5, // 5/16
-  3,7,5,0, // 6/16
-  4,3,7,5, // 7/16
-  5,0,0,0, // 8/16
-  5,6,2,5};// 9/16
+  whole=result[BCD_DEC];
+  decs=result[BCD_LEN]-whole;
+  fours=amount/4;
 
-  unsigned char accum[6];
+  //decimal places 4 bit steps would leave and places to work to
+  if (fours==0) dec_out=decs;
+  else if (decs+4*fours<Settings.WorkPlaces) dec_out=decs+4*fours;
+  else dec_out=Settings.WorkPlaces;
+  places=dec_out;
+  if (places<Settings.WorkPlaces) places=Settings.WorkPlaces;
 
-  CopyBCD_ItI(result,arg);
+  i_end=whole+places+3;
+  for (i=result[BCD_LEN]+3;i<i_end;i++) result[i]=0;
 
   while (amount)
   {
-    if (amount>3)
+    k=amount;
+    if (k>ROR_CHUNK) k=ROR_CHUNK;
+    amount-=k;
+    mask=(1UL<<k)-1;
+    rem=0;
+    for (i=3;i<i_end;i++)
     {
-      for (i=0;i<6;i++) accum[i]=0;
-      amount-=4;
-
-      t1=result[BCD_DEC];
-      b0=0;
-      i_end=result[BCD_LEN]+3;
-      for (i=3;i<i_end;i++)
-      {
-        b1=0;
-        b2=result[i]*4;
-        for (j=3;j>=-1;j--)
-        {
-          if (j>=0) accum[b0+j]+=table[b2+j]+b1;
-          else accum[b0+j]+=b1;
-
-          if (accum[b0+j]>9)
-          {
-            accum[b0+j]-=10;
-            b1=1;
-          }
-          else b1=0;
-        }
-
-        if (b0!=2) b0++;
-        else
-        {
-          if (t1) result[i-2]=accum[0];
-          else result[i-1]=accum[0];
-
-          for (j=0;j<5;j++) accum[j]=accum[j+1];
-          accum[5]=0;
-        }
-      }
+      cur=(rem<<3)+(rem<<1)+result[i];
+      result[i]=cur>>k;
+      rem=cur&mask;
+    }
+    if (rem) lost=true;
+  }
 
-      b1=result[BCD_LEN]+3;
-      if (t1)
-      {
-        t1--;
-        result[BCD_LEN]=b1;
-        result[BCD_DEC]=t1;
-        b2=i-b0;
-      }
-      else
-      {
-        b1++;
-        result[3]=0;
-        result[BCD_LEN]=b1;
-        b2=i-b0+1;
-      }
-      for (j=0;j<5;j++) result[j+b2]=accum[j];
+  //4 bit steps take off one whole digit each. those digits are now 0
+  k=fours;
+  if (k>whole) k=whole;
+  if (k)
+  {
+    for (i=3;i<i_end-k;i++) result[i]=result[i+k];
+    whole-=k;
+    i_end-=k;
+  }
 
-      if ((b1-t1)>Settings.DecPlaces) result[BCD_LEN]=t1+Settings.DecPlaces;
-    }
-    else
+  //exact results keep only the places they need
+  keep=places;
+  if (!lost)
+  {
+    for (i=places;i>dec_out;i--)
     {
-      amount--;
-      i_end=result[BCD_LEN]+3;
-      b1=0;
-      for (i=3;i<i_end;i++)
-      {
-        b0=result[i];
-        b2=b0;
-        b0=(b0>>1)+b1;
-        b1=0;
-        if (b2&1) b1=8;
-        if (b0>7) b0-=3;
-        result[i]=b0;
-      }
-      if (b1)
-      {
-        if((result[BCD_LEN]-result[BCD_DEC])<Settings.DecPlaces)
-        {
-          b1=result[BCD_LEN]+1;
-          result[BCD_LEN]=b1;
-          result[b1+2]=5;
-        }
-      }
+      if (result[whole+i+2]) break;
     }
+    keep=i;
   }
+  result[BCD_DEC]=whole;
+  result[BCD_LEN]=whole+keep;
 }
 
-//result-internal, base-external, exp-internal
+//result, base and exp are all internal. CacheLookup and CacheStore read
+//base and exp directly as the key
 static void PowBCD(unsigned char *result, unsigned char *base, unsigned char *exp)
 {
+  if (CacheLookup(CACHE_POW,base,exp,result,0)) return;
   LnBCD(p3,base);
   MultBCD(p4,p3,exp);
   ExpBCD(result,p4);
+  //ln then exp is only good to WorkPlaces significant digits
+  if (result[BCD_DEC]>Settings.WorkPlaces) result[BCD_LEN]=result[BCD_DEC];
+  else if (result[BCD_LEN]>Settings.WorkPlaces) result[BCD_LEN]=Settings.WorkPlaces;
+  CacheStore(CACHE_POW,base,exp,result,0);
 }
 
 static void TanBCD(unsigned char *sine_result,unsigned char *cos_result,unsigned char *arg)
@@ -3509,19 +4296,21 @@ static void TanBCD(unsigned char *sine_result,unsigned char *cos_result,unsigned
   //#pragma MM_VAR sine_result
   //#pragma MM_VAR cos_result
 
+  if (CacheLookup(CACHE_TAN,arg,0,sine_result,cos_result)) return;
+
   CopyBCD_ItI(p2,perm_zero);
   CopyBCD_ItI(sine_result,perm_zero);
   CopyBCD_ItI(cos_result,perm_K);
 
-  CalcTanBCD(sine_result,cos_result,p2,arg,0);
-  sine_result[BCD_LEN]=Settings.DecPlaces;
-  cos_result[BCD_LEN]=Settings.DecPlaces;
+  CalcTanBCD(sine_result,cos_result,p2,arg,CORDIC_ROTATE);
+  TrimBCD(sine_result);
+  TrimBCD(cos_result);
+  CacheStore(CACHE_TAN,arg,0,sine_result,cos_result);
 }
 
 static void AcosBCD(unsigned char *result,unsigned char *arg)
 {
-  CopyBCD_ItI(p0,arg);
-  MultBCD(p1,p0,arg);
+  SquareBCD(p1,arg);
   ImmedBCD_RAM("1",p0);
   SubBCD(p5,p0,p1);
   ImmedBCD_RAM("0.5",p6);
@@ -3532,8 +4321,7 @@ static void AcosBCD(unsigned char *result,unsigned char *arg)
 
 static void AsinBCD(unsigned char *result,unsigned char *arg)
 {
-  CopyBCD_ItI(p0,arg);
-  MultBCD(p1,p0,arg);
+  SquareBCD(p1,arg);
   ImmedBCD_RAM("1",p0);
   SubBCD(p5,p0,p1);
   ImmedBCD_RAM("0.5",p6);
@@ -3546,138 +4334,1790 @@ static void AtanBCD(unsigned char *result,unsigned char *arg)
 {
   //#pragma MM_VAR result
 
+  if (CacheLookup(CACHE_ATAN,arg,0,result,0)) return;
+
   CopyBCD_ItI(result,perm_zero);
   ImmedBCD_RAM("1",p2);
   CopyBCD_ItI(p3,arg);
-  CalcTanBCD(p2,p3,result,arg,1);
+  CalcTanBCD(p2,p3,result,arg,CORDIC_VECTOR);
 
-  if ((result[BCD_DEC]<=Settings.DecPlaces)&&(result[BCD_LEN]>Settings.DecPlaces)) result[BCD_LEN]=Settings.DecPlaces;
+  TrimBCD(result);
+  CacheStore(CACHE_ATAN,arg,0,result,0);
 }
 
+//flag is CORDIC_ROTATE or CORDIC_VECTOR, or'd with CORDIC_HYP for the hyperbolic version
+//Hyperbolic uses atanh(2^-i) from i=1 and does 4, 13, 40... twice to converge
 static void CalcTanBCD(unsigned char *result1,unsigned char *result2,unsigned char *result3,unsigned char *arg,unsigned char flag)
 {
   //#pragma MM_VAR result2
 
-  unsigned int i;
-  unsigned int trig_ptr=0;
+  unsigned int i,shift,repeat=4;
+  unsigned int entry=0,table_size;
+  bool hyperbolic,positive,adding;
+
+  hyperbolic=flag&CORDIC_HYP;
+  if (hyperbolic) table_size=Settings.HypTableSize;
+  else table_size=Settings.TrigTableSize;
 
   //function pointers could reduce flash size
-  for (i=0;i<Settings.TrigTableSize;i++)
+  for (i=0;i<table_size;i++)
   {
     #define DEBUGTIME 0
-    if (flag==0) SubBCD(p1,arg,result3);
+    if (IdleAbort()) break;
+    if ((flag&CORDIC_VECTOR)==0)
+    {
+      positive=(CompVarBCD_ItI(arg,result3)!=COMP_LT);
+    }
+    else positive=(result2[BCD_SIGN]==0);
 
-    if (((flag==0)&&(p1[BCD_SIGN]==0))||((flag==1)&&(result2[BCD_SIGN]==0)))
+    if (hyperbolic)
     {
-      RorBCD(p0,result2,i);
-      AddBCD(p1,result1,p0);
-      RorBCD(p0,result1,i);
-      CopyBCD_ItI(result1,p1);
-      SubBCD(p1,result2,p0);
-      CopyBCD_ItI(result2,p1);
-      CopyBCD_EtI(perm_buff1,trig+trig_ptr);
-      AddBCD(p0,result3,perm_buff1);
+      shift=i+1;
+      //rotating adds to both, vectoring subtracts from both
+      adding=(positive==((flag&CORDIC_VECTOR)==0));
+      //both shifts are taken before either result changes
+      RorBCD(p0,result2,shift);
+      RorBCD(p1,result1,shift);
+      SumBCD(result1,result1,p0,!adding);
+      SumBCD(result2,result2,p1,!adding);
+      TableEntry(perm_buff1,TABLE_HYP,entry);
     }
     else
     {
       RorBCD(p0,result2,i);
-      SubBCD(p1,result1,p0);
-      RorBCD(p0,result1,i);
-      CopyBCD_ItI(result1,p1);
-      AddBCD(p1,result2,p0);
-      CopyBCD_ItI(result2,p1);
-      CopyBCD_EtI(perm_buff1,trig+trig_ptr);
-      SubBCD(p0,result3,perm_buff1);
+      RorBCD(p1,result1,i);
+      SumBCD(result1,result1,p0,!positive);
+      SumBCD(result2,result2,p1,positive);
+      TableEntry(perm_buff1,TABLE_TRIG,entry);
     }
+    SumBCD(result3,result3,perm_buff1,!positive);
 
-    CopyBCD_ItI(result3,p0);
-    trig_ptr+=MATH_ENTRY_SIZE;
+    if ((hyperbolic)&&(shift==repeat))
+    {
+      repeat=3*repeat+1;
+      i--;
+    }
+    else entry++;
   }
 }
 
-//var is external???
-static unsigned char CompBCD(const char *num, unsigned char *var)
+//sinh and cosh. Argument reduced by ln(2^128)..ln(2) from log table then
+//cosh=(2^q*e^r+2^-q*e^-r)/2 and sinh=(2^q*e^r-2^-q*e^-r)/2
+static void HypBCD(unsigned char *sinh_result,unsigned char *cosh_result,unsigned char *arg)
 {
-  ImmedBCD_RAM(num,p0);
-  CopyBCD_EtI(local_buff1,var);
-  return CompVarBCD(p0,local_buff1);
-}
+  unsigned int i,j=128,q=0;
+  bool negative;
 
-static unsigned char CompBCD_RAM(const char *num, unsigned char *var)
-{
-  ImmedBCD_RAM(num,p0);
-  return CompVarBCD_ItI(p0,var);
-}
+  negative=(arg[BCD_SIGN]==1);
+  CopyBCD_ItI(p3,arg);
+  p3[BCD_SIGN]=0;
 
-//Should fail if ever called since cant SubBCD on externals
-static unsigned char CompVarBCD(unsigned char *var1, unsigned char *var2)
-{
-  SubBCD(p1,var1,var2);
-  if (IsZero_RAM(p1)) return COMP_EQ;
-  else if (p1[BCD_SIGN]==0) return COMP_GT;
-  else return COMP_LT;
+  for (i=0;i<8;i++)
+  {
+    TableEntry(perm_buff1,TABLE_LOG,i);
+    if (CompVarBCD_ItI(p3,perm_buff1)!=COMP_LT)
+    {
+      SubBCD(p3,p3,perm_buff1);
+      q+=j;
+    }
+    j>>=1;
+  }
+
+  CopyBCD_ItI(p2,perm_zero);
+  CopyBCD_ItI(sinh_result,perm_zero);
+  CopyBCD_ItI(cosh_result,perm_Kh);
+  CalcTanBCD(sinh_result,cosh_result,p2,p3,CORDIC_ROTATE|CORDIC_HYP);
+
+  if (q)
+  {
+    AddBCD(p0,cosh_result,sinh_result);
+    SubBCD(p1,cosh_result,sinh_result);
+    RolBCD(p5,p0,q);
+    RorBCD(p6,p1,q);
+    AddBCD(p0,p5,p6);
+    RorBCD(cosh_result,p0,1);
+    SubBCD(p0,p5,p6);
+    RorBCD(sinh_result,p0,1);
+  }
+
+  TrimBCD(sinh_result);
+  TrimBCD(cosh_result);
+  if (negative) sinh_result[BCD_SIGN]=1;
 }
 
-static unsigned char CompVarBCD_ItE(unsigned char *var1, unsigned char *var2)
+//asinh(x)=atanh(x/sqrt(x^2+1)) while that converges, otherwise ln(x+sqrt(x^2+1))
+static void AsinhBCD(unsigned char *result,unsigned char *arg)
 {
-  /*SubBCD(p1,var1,var2);
-  if (IsZero_RAM(p1)) return COMP_EQ;
-  else if (p1[BCD_SIGN]==0) return COMP_GT;
-  else return COMP_LT;*/
-  return 0;
+  bool negative;
+
+  negative=(arg[BCD_SIGN]==1);
+  CopyBCD_ItI(p3,arg);
+  p3[BCD_SIGN]=0;
+  if (IsZero_RAM(p3))
+  {
+    CopyBCD_ItI(result,perm_zero);
+    return;
+  }
+
+  SquareBCD(p4,p3);
+  ImmedBCD_RAM("1",p7);
+  AddBCD(local_buff2,p4,p7);
+  SqrtHypBCD(p4,local_buff2);
+
+  if (CompBCD_RAM("1.2",p3)==COMP_GT)
+  {
+    CopyBCD_ItI(result,perm_zero);
+    CalcTanBCD(p4,p3,result,p3,CORDIC_VECTOR|CORDIC_HYP);
+  }
+  else
+  {
+    AddBCD(local_buff2,p3,p4);
+    LnBCD(result,local_buff2);
+  }
+
+  TrimBCD(result);
+  if (negative) result[BCD_SIGN]=1;
 }
 
-static unsigned char CompVarBCD_ItI(unsigned char *var1, unsigned char *var2)
+//acosh(x)=atanh(sqrt(x^2-1)/x) while that converges, otherwise ln(x+sqrt(x^2-1))
+//x>=1
+static void AcoshBCD(unsigned char *result,unsigned char *arg)
 {
-  SubBCD(p1,var1,var2);
-  if (IsZero_RAM(p1)) return COMP_EQ;
-  else if (p1[BCD_SIGN]==0) return COMP_GT;
-  else return COMP_LT;
-}
+  CopyBCD_ItI(p3,arg);
+  SquareBCD(p4,p3);
+  ImmedBCD_RAM("1",p7);
+  SubBCD(local_buff2,p4,p7);
+  if (IsZero_RAM(local_buff2))
+  {
+    CopyBCD_ItI(result,perm_zero);
+    return;
+  }
+  SqrtHypBCD(p4,local_buff2);
 
+  if (CompBCD_RAM("1.6",p3)==COMP_GT)
+  {
+    CopyBCD_ItI(result,perm_zero);
+    CalcTanBCD(p3,p4,result,p3,CORDIC_VECTOR|CORDIC_HYP);
+  }
+  else
+  {
+    AddBCD(local_buff2,p3,p4);
+    LnBCD(result,local_buff2);
+  }
 
+  TrimBCD(result);
+}
 
-//convert angle to 0-90 format and put in p3
-static unsigned char TrigPrep(unsigned int stack_ptr_copy,int *cosine)
+//atanh(x) directly by vectoring up to 0.75, otherwise ln((1+x)/(1-x))/2
+//-1<x<1
+static void AtanhBCD(unsigned char *result,unsigned char *arg)
 {
-  int sine;
+  bool negative;
 
-  if (Settings.DegRad) CopyBCD_EtI(p3,BCD_stack+(stack_ptr_copy-1)*MATH_CELL_SIZE);
+  negative=(arg[BCD_SIGN]==1);
+  CopyBCD_ItI(p3,arg);
+  p3[BCD_SIGN]=0;
+  if (IsZero_RAM(p3))
+  {
+    CopyBCD_ItI(result,perm_zero);
+    return;
+  }
+
+  if (CompBCD_RAM("0.75",p3)==COMP_GT)
+  {
+    ImmedBCD_RAM("1",p4);
+    CopyBCD_ItI(result,perm_zero);
+    CalcTanBCD(p4,p3,result,p3,CORDIC_VECTOR|CORDIC_HYP);
+  }
   else
   {
-    ImmedBCD_RAM(deg_factor,p0);
-    //p1 should be free?
-    CopyBCD_EtI(p1,BCD_stack+(stack_ptr_copy-1)*MATH_CELL_SIZE);
-    MultBCD(p3,p1,p0);
+    ImmedBCD_RAM("1",p7);
+    AddBCD(p4,p7,p3);
+    SubBCD(p5,p7,p3);
+    DivBCD(local_buff2,p4,p5);
+    LnBCD(p6,local_buff2);
+    RorBCD(result,p6,1);
   }
 
-  ImmedBCD_RAM("360",p2);
-  //Copy p1 since it has left over from CompVarBCD
-  while(CompVarBCD_ItI(p3,p2)==COMP_GT) CopyBCD(p3,p1);
+  TrimBCD(result);
+  if (negative) result[BCD_SIGN]=1;
+}
 
-  if (CompBCD_RAM("180",p3)==COMP_LT)
+//Square root by hyperbolic vectoring: x ends as K*sqrt((s+1)^2-(s-1)^2)=K*2*sqrt(s)
+//s is scaled by 4 into 1-4 first which keeps (s-1)/(s+1) in range
+//arg>0
+static void SqrtHypBCD(unsigned char *result,unsigned char *arg)
+{
+  int k=0;
+
+  if (IsZero_RAM(arg))
   {
-    SubBCD(stack_buffer,p2,p3);
-    sine=1;
+    CopyBCD_ItI(result,perm_zero);
+    return;
   }
-  else
+
+  CopyBCD_ItI(p5,arg);
+  while (CompBCD_RAM("4",p5)!=COMP_GT)
   {
-    CopyBCD_ItI(stack_buffer,p3);
-    sine=0;
+    RorBCD(p5,p5,2);
+    k++;
   }
-  if (CompBCD_RAM("90",stack_buffer)==COMP_LT)
+  while (CompBCD_RAM("1",p5)==COMP_GT)
   {
-    ImmedBCD_RAM("180",p2);
-    SubBCD(p3,p2,stack_buffer);
-    *cosine=1;
+    RolBCD(p5,p5,2);
+    k--;
   }
-  else
+
+  ImmedBCD_RAM("1",p7);
+  AddBCD(result,p5,p7);
+  SubBCD(p6,p5,p7);
+  CopyBCD_ItI(p2,perm_zero);
+  CalcTanBCD(result,p6,p2,p6,CORDIC_VECTOR|CORDIC_HYP);
+
+  MultBCD(p6,result,perm_Kh);
+  RorBCD(result,p6,1);
+  if (k>0) RolBCD(result,result,k);
+  else if (k<0) RorBCD(result,result,-k);
+}
+
+//sqrt(a^2+b^2) by circular vectoring: x ends as sqrt(a^2+b^2)/K. One pass
+//instead of two squares and a PowBCD and nothing is rounded in between
+static void HypotBCD(unsigned char *result,unsigned char *a,unsigned char *b)
+{
+  CopyBCD_ItI(p2,a);
+  CopyBCD_ItI(p3,b);
+  p2[BCD_SIGN]=0;
+  p3[BCD_SIGN]=0;
+  if (IsZero_RAM(p2))
   {
-    CopyBCD_ItI(p3,stack_buffer);
-    *cosine=0;
+    CopyBCD_ItI(result,p3);
+    return;
+  }
+  if (IsZero_RAM(p3))
+  {
+    CopyBCD_ItI(result,p2);
+    return;
+  }
+
+  CopyBCD_ItI(p4,perm_zero);
+  CalcTanBCD(p2,p3,p4,p4,CORDIC_VECTOR);
+  MultBCD(result,p2,perm_K);
+}
+
+static void HpHead(struct HpHeadType *head, const unsigned char *cell)
+{
+  unsigned char buff[HP_HEADER];
+  RAM_ReadBlock(buff,cell,HP_HEADER);
+  head->sign=buff[HP_SIGN];
+  head->len=buff[HP_LEN];
+  head->exp=(short)(buff[HP_EXP]|(buff[HP_EXP+1]<<8));
+}
+
+static void HpSetHead(unsigned char *cell, unsigned char sign, int len, int exp)
+{
+  unsigned char buff[HP_HEADER];
+  buff[HP_SIGN]=sign;
+  buff[HP_LEN]=len;
+  buff[HP_EXP]=exp&0xFF;
+  buff[HP_EXP+1]=(exp>>8)&0xFF;
+  RAM_WriteBlock(cell,buff,HP_HEADER);
+}
+
+//Limbs outside 0 to len-1 read as 0 so operands can be shifted and padded
+//without being moved
+static void HpLoad(unsigned short *win, const unsigned char *cell, int len, int start, int count)
+{
+  int i,from=start,to=start+count;
+
+  if (from<0) from=0;
+  if (to>len) to=len;
+  for (i=0;i<count;i++) win[i]=0;
+  if (from<to) RAM_ReadBlock((unsigned char *)(win+from-start),cell+HP_HEADER+2*from,2*(to-from));
+}
+
+static void HpStore(unsigned char *cell, int start, const unsigned short *win, int count)
+{
+  RAM_WriteBlock(cell+HP_HEADER+2*start,(const unsigned char *)win,2*count);
+}
+
+static void HpCopy(unsigned char *dest, const unsigned char *src)
+{
+  struct HpHeadType head;
+  int i,count;
+
+  if (dest==src) return;
+  HpHead(&head,src);
+  for (i=0;i<head.len;i+=count)
+  {
+    count=head.len-i;
+    if (count>2*HP_WINDOW) count=2*HP_WINDOW;
+    HpLoad(hp_wp,src,head.len,i,count);
+    HpStore(dest,i,hp_wp,count);
+  }
+  HpSetHead(dest,head.sign,head.len,head.exp);
+}
+
+//value*LIMB_BASE^scale
+static void HpSetInt(unsigned char *cell, unsigned long long value, int scale)
+{
+  int i,count=0;
+  unsigned short limbs[5];
+
+  while (value)
+  {
+    limbs[count++]=value%LIMB_BASE;
+    value/=LIMB_BASE;
+  }
+  for (i=0;i<count;i++) hp_wa[i]=limbs[count-1-i];
+  HpStore(cell,0,hp_wa,count);
+  if (count) HpSetHead(cell,0,count,count+scale);
+  else HpSetHead(cell,0,0,0);
+}
+
+//COMP_GT if |a|>|b|. Only the first hp_prec limbs count
+static unsigned char HpCompMag(const unsigned char *a, const struct HpHeadType *ha, const unsigned char *b, const struct HpHeadType *hb)
+{
+  int i,j,count;
+
+  if (ha->len==0) return hb->len?COMP_LT:COMP_EQ;
+  if (hb->len==0) return COMP_GT;
+  if (ha->exp!=hb->exp) return (ha->exp>hb->exp)?COMP_GT:COMP_LT;
+  for (i=0;(i<hp_prec)&&((i<ha->len)||(i<hb->len));i+=count)
+  {
+    count=hp_prec-i;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    HpLoad(hp_wa,a,ha->len,i,count);
+    HpLoad(hp_wb,b,hb->len,i,count);
+    for (j=0;j<count;j++) if (hp_wa[j]!=hp_wb[j]) return (hp_wa[j]>hp_wb[j])?COMP_GT:COMP_LT;
+  }
+  return COMP_EQ;
+}
+
+//Moves the first len-1 limbs one place toward the end and puts top in limb 0
+//Works from the end so nothing is overwritten before it's read
+static void HpShiftDown(unsigned char *cell, int len, unsigned short top)
+{
+  int start,end,count;
+
+  for (end=len;end>0;end=start)
+  {
+    start=end-HP_WINDOW;
+    if (start<0) start=0;
+    count=end-start;
+    HpLoad(hp_wa,cell,len,start-1,count);
+    if (start==0) hp_wa[0]=top;
+    HpStore(cell,start,hp_wa,count);
+  }
+}
+
+//Moves limbs amount places toward limb 0 and fills the end with zeros
+static void HpShiftUp(unsigned char *cell, int len, int amount)
+{
+  int start,count;
+
+  for (start=0;start<len;start+=count)
+  {
+    count=len-start;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    HpLoad(hp_wa,cell,len,start+amount,count);
+    HpStore(cell,start,hp_wa,count);
+  }
+}
+
+static int HpLeadZeros(const unsigned char *cell, int len)
+{
+  int i,j,count;
+
+  for (i=0;i<len;i+=count)
+  {
+    count=len-i;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    HpLoad(hp_wa,cell,len,i,count);
+    for (j=0;j<count;j++) if (hp_wa[j]) return i+j;
+  }
+  return len;
+}
+
+//result can be a or b. negate flips the sign of b so HpSum(r,a,b,1) is a-b
+//The bigger magnitude goes first and the other is shifted by the exponent
+//difference as it's read. Windows run from the last limb so carries and
+//borrows go the right way and an aliased operand is read before it's written
+static void HpSum(unsigned char *result, const unsigned char *a, const unsigned char *b, unsigned char negate)
+{
+  struct HpHeadType ha,hb,head_temp;
+  const unsigned char *ptr_temp;
+  int i,start,end,count,shift,n;
+  long value;
+  unsigned char carry=0,subtract,comp;
+
+  HpHead(&ha,a);
+  HpHead(&hb,b);
+  hb.sign^=negate;
+  if (hb.len==0)
+  {
+    HpCopy(result,a);
+    return;
+  }
+  if (ha.len==0)
+  {
+    HpCopy(result,b);
+    HpSetHead(result,hb.sign,hb.len,hb.exp);
+    return;
+  }
+
+  subtract=(ha.sign!=hb.sign);
+  comp=HpCompMag(a,&ha,b,&hb);
+  if ((subtract)&&(comp==COMP_EQ))
+  {
+    HpSetHead(result,0,0,0);
+    return;
+  }
+  if (comp==COMP_LT)
+  {
+    ptr_temp=a;
+    a=b;
+    b=ptr_temp;
+    head_temp=ha;
+    ha=hb;
+    hb=head_temp;
+  }
+
+  shift=ha.exp-hb.exp;
+  if (shift>=hp_prec)
+  {
+    HpCopy(result,a);
+    HpSetHead(result,ha.sign,ha.len,ha.exp);
+    return;
+  }
+  n=hb.len+shift;
+  if (ha.len>n) n=ha.len;
+  if (n>hp_prec) n=hp_prec;
+
+  for (end=n;end>0;end=start)
+  {
+    start=end-HP_WINDOW;
+    if (start<0) start=0;
+    count=end-start;
+    HpLoad(hp_wa,a,ha.len,start,count);
+    HpLoad(hp_wb,b,hb.len,start-shift,count);
+    for (i=count-1;i>=0;i--)
+    {
+      if (subtract) value=(long)hp_wa[i]-hp_wb[i]-carry;
+      else value=(long)hp_wa[i]+hp_wb[i]+carry;
+      carry=0;
+      if (value<0)
+      {
+        value+=LIMB_BASE;
+        carry=1;
+      }
+      else if (value>=LIMB_BASE)
+      {
+        value-=LIMB_BASE;
+        carry=1;
+      }
+      hp_wa[i]=value;
+    }
+    HpStore(result,start,hp_wa,count);
+  }
+
+  if (carry)
+  {
+    if (n<hp_prec) n++;
+    HpShiftDown(result,n,1);
+    ha.exp++;
+  }
+  else if (subtract)
+  {
+    i=HpLeadZeros(result,n);
+    if (i==n)
+    {
+      HpSetHead(result,0,0,0);
+      return;
+    }
+    if (i)
+    {
+      HpShiftUp(result,n,i);
+      ha.exp-=i;
+    }
+  }
+  HpSetHead(result,ha.sign,n,ha.exp);
+}
+
+//m below LIMB_BASE. result can be a
+static void HpMulSmall(unsigned char *result, const unsigned char *a, unsigned int m)
+{
+  struct HpHeadType head;
+  int i,start,end,count,n;
+  unsigned long value,carry=0;
+
+  HpHead(&head,a);
+  if ((head.len==0)||(m==0))
+  {
+    HpSetHead(result,0,0,0);
+    return;
+  }
+  n=head.len;
+  if (n>hp_prec) n=hp_prec;
+  for (end=n;end>0;end=start)
+  {
+    start=end-HP_WINDOW;
+    if (start<0) start=0;
+    count=end-start;
+    HpLoad(hp_wa,a,head.len,start,count);
+    for (i=count-1;i>=0;i--)
+    {
+      value=(unsigned long)hp_wa[i]*m+carry;
+      hp_wa[i]=value%LIMB_BASE;
+      carry=value/LIMB_BASE;
+    }
+    HpStore(result,start,hp_wa,count);
+  }
+  if (carry)
+  {
+    if (n<hp_prec) n++;
+    HpShiftDown(result,n,carry);
+    head.exp++;
+  }
+  HpSetHead(result,head.sign,n,head.exp);
+}
+
+//Long division by a small number from the first limb. A first limb below m
+//goes straight into the remainder so the quotient comes out normalized
+static void HpDivSmall(unsigned char *result, const unsigned char *a, unsigned int m)
+{
+  struct HpHeadType head;
+  int i,start,count,first=0;
+  unsigned long value,rem=0;
+
+  HpHead(&head,a);
+  if (head.len==0)
+  {
+    HpSetHead(result,0,0,0);
+    return;
+  }
+  HpLoad(hp_wa,a,head.len,0,1);
+  if (hp_wa[0]<m)
+  {
+    first=1;
+    rem=hp_wa[0];
+    head.exp--;
+  }
+  for (start=0;start<hp_prec;start+=count)
+  {
+    count=hp_prec-start;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    HpLoad(hp_wa,a,head.len,start+first,count);
+    for (i=0;i<count;i++)
+    {
+      value=rem*LIMB_BASE+hp_wa[i];
+      hp_wa[i]=value/m;
+      rem=value%m;
+    }
+    HpStore(result,start,hp_wa,count);
+  }
+  HpSetHead(result,head.sign,hp_prec,head.exp);
+}
+
+//Schoolbook in HP_WINDOW by HP_WINDOW blocks except the top h by h limbs,
+//which HpKaratsuba does once h reaches HP_KARATSUBA. A block is skipped once
+//the window starts i+j are past hp_prec. Its top product lands at limb
+//hp_prec+2 or later so the skipped blocks add up to at most hp_prec in the
+//last limb kept, which the guard limbs take
+static void HpMult(unsigned char *result, const unsigned char *a, const unsigned char *b)
+{
+  struct HpHeadType ha,hb;
+  int i,k,h=0,a_len,b_len,total,first,n=hp_prec;
+
+  HpHead(&ha,a);
+  HpHead(&hb,b);
+  if ((ha.len==0)||(hb.len==0))
+  {
+    HpSetHead(result,0,0,0);
+    return;
+  }
+  a_len=ha.len;
+  if (a_len>n) a_len=n;
+  b_len=hb.len;
+  if (b_len>n) b_len=n;
+  total=a_len+b_len;
+
+  for (i=0;i<2*total;i+=k)
+  {
+    k=2*total-i;
+    if (k>MATH_CELL_SIZE) k=MATH_CELL_SIZE;
+    RAM_WriteBlock(hp_prod+HP_HEADER+i,zero_digits,k);
+  }
+
+  //h is whole windows in each half so the blocks left are the schoolbook ones.
+  //Its last blocks start at h-HP_WINDOW so the schoolbook would do them all
+  h=(n/2+HP_WINDOW)&~(2*HP_WINDOW-1);
+  if ((h>=HP_KARATSUBA)&&(a_len>=h)&&(b_len>=h))
+  {
+    HpKaratsuba(a,ha.len,b,hb.len,h,total);
+    HpBlocks(hp_prod,a,ha.len,0,h,b,hb.len,h,b_len,n);
+    HpBlocks(hp_prod,a,ha.len,h,a_len,b,hb.len,0,b_len,n);
+  }
+  else HpBlocks(hp_prod,a,ha.len,0,a_len,b,hb.len,0,b_len,n);
+
+  HpLoad(hp_wa,hp_prod,total,0,1);
+  first=(hp_wa[0]==0);
+  if (n>total-first) n=total-first;
+  for (i=0;i<n;i+=k)
+  {
+    k=n-i;
+    if (k>2*HP_WINDOW) k=2*HP_WINDOW;
+    HpLoad(hp_wp,hp_prod,total,i+first,k);
+    HpStore(result,i,hp_wp,k);
+  }
+  HpSetHead(result,ha.sign^hb.sign,n,ha.exp+hb.exp-first);
+}
+
+//Adds limbs a_from to a_to of a times b_from to b_to of b into prod a block
+//at a time. Blocks with window starts past limit are skipped. One window of a
+//is held while windows of b stream past
+static void HpBlocks(unsigned char *prod, const unsigned char *a, int a_len, int a_from, int a_to,
+                     const unsigned char *b, int b_len, int b_from, int b_to, int limit)
+{
+  int i,j,k,x,y,a_count,b_count;
+
+  for (i=a_from;i<a_to;i+=HP_WINDOW)
+  {
+    a_count=a_to-i;
+    if (a_count>HP_WINDOW) a_count=HP_WINDOW;
+    HpLoad(hp_wa,a,a_len,i,a_count);
+    for (j=b_from;(j<b_to)&&(i+j<=limit);j+=HP_WINDOW)
+    {
+      b_count=b_to-j;
+      if (b_count>HP_WINDOW) b_count=HP_WINDOW;
+      HpLoad(hp_wb,b,b_len,j,b_count);
+      for (k=0;k<a_count+b_count-1;k++) hp_cols[k]=0;
+      for (x=0;x<a_count;x++)
+      {
+        if (hp_wa[x]==0) continue;
+        for (y=0;y<b_count;y++) hp_cols[x+y]+=(unsigned long)hp_wa[x]*hp_wb[y];
+      }
+      //a limb at i+x times one at j+y lands at limb i+x+j+y+1
+      HpAccum(prod,i+j+1,a_count+b_count-1);
+    }
+  }
+}
+
+//Adds the top h by h limbs of a times b into hp_prod, which is zero, with
+//three products of half the size. With m=h/2, a=A1 A0 and b=B1 B0 the middle
+//part X is (A1+A0)(B1+B0)-A1*B1-A0*B0 and goes in m limbs above A0*B0
+static void HpKaratsuba(const unsigned char *a, int a_len, const unsigned char *b, int b_len, int h, int total)
+{
+  int i,j,k,x,t,t0,end,count,m=h/2;
+  unsigned char carry_a,carry_b;
+  unsigned long column;
+  long value,carry;
+
+  //A1*B1 fills limbs 0 to h-1 and A0*B0 h to 2h-1 so they don't overlap
+  HpBlocks(hp_prod,a,a_len,0,m,b,b_len,0,m,h);
+  HpBlocks(hp_prod,a,a_len,m,h,b,b_len,m,h,2*h);
+
+  //(A1+A0)(B1+B0) a column at a time from the sums in internal RAM. hp_kmid
+  //limb k is worth LIMB_BASE^(h-k). The sums' carries are worth LIMB_BASE^m
+  //so they add the other sum from limb 1 and each other at limb 0
+  carry_a=HpHalves(hp_ka,a,a_len,m);
+  carry_b=HpHalves(hp_kb,b,b_len,m);
+  column=0;
+  for (end=h+1;end>1;end-=count)
+  {
+    count=end-1;
+    if (count>2*HP_WINDOW) count=2*HP_WINDOW;
+    for (k=end-1;k>=end-count;k--)
+    {
+      //ka limb x times kb limb y lands at limb x+y+2
+      x=k-2-m+1;
+      if (x<0) x=0;
+      for (;(x<m)&&(x<=k-2);x++) column+=(unsigned long)hp_ka[x]*hp_kb[k-2-x];
+      if (k<=m) column+=carry_a*hp_kb[k-1]+carry_b*hp_ka[k-1];
+      hp_wp[k-end+count]=column%LIMB_BASE;
+      column/=LIMB_BASE;
+    }
+    HpStore(hp_kmid,end-count,hp_wp,count);
+  }
+  hp_wp[0]=column+(carry_a&carry_b);
+  HpStore(hp_kmid,0,hp_wp,1);
+
+  //One pass from the bottom adds X limb t at limb 3m-1-t. Limbs written while
+  //t<m still hold A0*B0 limb t+m so they're kept in hp_cols for later
+  carry=0;
+  for (t0=0;t0<=h;t0+=count)
+  {
+    count=h+1-t0;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    HpLoad(hp_wa,hp_prod,total,3*m-t0-count,count);
+    HpLoad(hp_wp,hp_kmid,h+1,h+1-t0-count,count);
+    HpLoad(hp_wb,hp_prod,h,h-t0-count,count);
+    if (t0<m) HpLoad(hp_wp+HP_WINDOW,hp_prod+2*h,h,h-t0-count,count);
+    for (j=count-1;j>=0;j--)
+    {
+      t=t0+count-1-j;
+      value=(long)hp_wa[j]+hp_wp[j]-hp_wb[j]+carry;
+      if (t<m)
+      {
+        value-=hp_wp[HP_WINDOW+j];
+        hp_cols[t]=hp_wa[j];
+      }
+      else if (t<h) value-=hp_cols[t-m];
+      for (carry=0;value<0;carry--) value+=LIMB_BASE;
+      for (;value>=LIMB_BASE;carry++) value-=LIMB_BASE;
+      hp_wa[j]=value;
+    }
+    HpStore(hp_prod,3*m-t0-count,hp_wa,count);
+  }
+  for (i=m-2;carry;i--)
+  {
+    HpLoad(hp_wa,hp_prod,total,i,1);
+    value=hp_wa[0]+carry;
+    carry=(value>=LIMB_BASE);
+    if (carry) value-=LIMB_BASE;
+    hp_wa[0]=value;
+    HpStore(hp_prod,i,hp_wa,1);
+  }
+}
+
+//sum=high m limbs of x plus the next m. Returns the carry out of the top
+static unsigned char HpHalves(unsigned short *sum, const unsigned char *x, int x_len, int m)
+{
+  int i,start,count,end;
+  unsigned long value,carry=0;
+
+  for (end=m;end>0;end-=count)
+  {
+    count=end;
+    if (count>HP_WINDOW) count=HP_WINDOW;
+    start=end-count;
+    HpLoad(hp_wa,x,x_len,start,count);
+    HpLoad(hp_wb,x,x_len,m+start,count);
+    for (i=count-1;i>=0;i--)
+    {
+      value=hp_wa[i]+hp_wb[i]+carry;
+      carry=(value>=LIMB_BASE);
+      if (carry) value-=LIMB_BASE;
+      sum[start+i]=value;
+    }
+  }
+  return carry;
+}
+
+//Adds hp_cols into prod from limb pos. Carries run on toward limb 0
+static void HpAccum(unsigned char *prod, int pos, int count)
+{
+  int i;
+  unsigned long value,carry=0;
+
+  RAM_ReadBlock((unsigned char *)hp_wp,prod+HP_HEADER+2*pos,2*count);
+  for (i=count-1;i>=0;i--)
+  {
+    value=hp_wp[i]+hp_cols[i]+carry;
+    hp_wp[i]=value%LIMB_BASE;
+    carry=value/LIMB_BASE;
+  }
+  RAM_WriteBlock(prod+HP_HEADER+2*pos,(unsigned char *)hp_wp,2*count);
+  for (pos--;carry;pos--)
+  {
+    RAM_ReadBlock((unsigned char *)hp_wp,prod+HP_HEADER+2*pos,2);
+    value=hp_wp[0]+carry;
+    hp_wp[0]=value%LIMB_BASE;
+    carry=value/LIMB_BASE;
+    RAM_WriteBlock(prod+HP_HEADER+2*pos,(unsigned char *)hp_wp,2);
+  }
+}
+
+//Limbs for each Newton step up to target, smallest first. The error squares
+//every step so each only needs about twice the limbs of the one before and
+//the whole thing costs a few multiplies at target. Two limbs over half
+//covers what the step before loses to rounding
+static int HpSteps(int *steps, int target)
+{
+  int i,temp,count=0;
+
+  for (;target>4;target=target/2+2) steps[count++]=target;
+  for (i=0;i<count/2;i++)
+  {
+    temp=steps[i];
+    steps[i]=steps[count-1-i];
+    steps[count-1-i]=temp;
+  }
+  return count;
+}
+
+static unsigned long HpIsqrt(unsigned long long value)
+{
+  unsigned long long root=0,bit=1ULL<<62;
+
+  while (bit>value) bit>>=2;
+  while (bit)
+  {
+    if (value>=root+bit)
+    {
+      value-=root+bit;
+      root=(root>>1)+bit;
+    }
+    else root>>=1;
+    bit>>=2;
+  }
+  return root;
+}
+
+//Newton: y=y+y*(1-d*y) starting from the first 3 limbs of d
+//Iterates in T0 with T1
+static void HpRecip(unsigned char *result, const unsigned char *d)
+{
+  struct HpHeadType head;
+  unsigned long long top;
+  int i,count,steps[HP_STEPS],prec=hp_prec;
+  unsigned char *y=HP_T(0),*t=HP_T(1);
+
+  HpHead(&head,d);
+  HpLoad(hp_wa,d,head.len,0,3);
+  top=((unsigned long long)hp_wa[0]*LIMB_BASE+hp_wa[1])*LIMB_BASE+hp_wa[2];
+  //d is top*LIMB_BASE^(exp-3) and 10^19 is LIMB_BASE^5/10
+  HpSetInt(y,(10000000000000000000ULL/top)*10,-2-head.exp);
+  if (head.sign)
+  {
+    HpHead(&head,y);
+    HpSetHead(y,1,head.len,head.exp);
+  }
+
+  count=HpSteps(steps,prec);
+  for (i=0;i<count;i++)
+  {
+    hp_prec=steps[i];
+    HpMult(t,d,y);
+    HpSum(t,hp_one,t,1);
+    HpMult(t,y,t);
+    HpSum(y,y,t,0);
+  }
+  hp_prec=prec;
+  HpCopy(result,y);
+}
+
+static void HpDiv(unsigned char *result, const unsigned char *a, const unsigned char *b)
+{
+  HpRecip(HP_T(0),b);
+  HpMult(result,a,HP_T(0));
+}
+
+//Newton for 1/sqrt(x) needs no division: r=r+r*(1-x*r*r)/2
+//Iterates in T0 with T1. x>0
+static void HpRsqrt(unsigned char *result, const unsigned char *x)
+{
+  struct HpHeadType head;
+  unsigned long long top=0;
+  int i,k,count,steps[HP_STEPS],prec=hp_prec;
+  unsigned char *r=HP_T(0),*t=HP_T(1);
+
+  //x is top*LIMB_BASE^(exp-k) with exp-k even
+  HpHead(&head,x);
+  k=4-(head.exp&1);
+  HpLoad(hp_wa,x,head.len,0,k);
+  for (i=0;i<k;i++) top=top*LIMB_BASE+hp_wa[i];
+  HpSetInt(r,(10000000000000000000ULL/HpIsqrt(top))*10,(k-head.exp)/2-5);
+
+  count=HpSteps(steps,prec);
+  for (i=0;i<count;i++)
+  {
+    hp_prec=steps[i];
+    HpMult(t,r,r);
+    HpMult(t,x,t);
+    HpSum(t,hp_one,t,1);
+    HpDivSmall(t,t,2);
+    HpMult(t,r,t);
+    HpSum(r,r,t,0);
+  }
+  hp_prec=prec;
+  HpCopy(result,r);
+}
+
+static void HpSqrt(unsigned char *result, const unsigned char *x)
+{
+  HpRsqrt(HP_T(0),x);
+  HpMult(result,x,HP_T(0));
+}
+
+//Arithmetic-geometric mean in T2-T5. Converges quadratically so once a and b
+//agree to half the limbs one more arithmetic mean is good to all of them
+static void HpAgm(unsigned char *result, const unsigned char *a, const unsigned char *b)
+{
+  struct HpHeadType ha,hd;
+  unsigned char *x=HP_T(2),*y=HP_T(3),*sum=HP_T(4),*diff=HP_T(5),*temp;
+  int i;
+
+  HpCopy(x,a);
+  HpCopy(y,b);
+  for (i=0;i<HP_AGM_MAX;i++)
+  {
+    HpSum(diff,x,y,1);
+    HpHead(&hd,diff);
+    HpHead(&ha,x);
+    if ((hd.len==0)||((ha.exp-hd.exp)>hp_prec/2)) break;
+    HpSum(sum,x,y,0);
+    HpDivSmall(sum,sum,2);
+    HpMult(y,x,y);
+    HpSqrt(y,y);
+    temp=x;
+    x=sum;
+    sum=temp;
+  }
+  HpSum(result,x,y,0);
+  HpDivSmall(result,result,2);
+}
+
+//Limbs for a constant that's out of date. Going to the most any kernel will
+//want at this setting means it's only worked out again if HpDigits goes up
+static int HpConstLimbs()
+{
+  int limbs=Settings.HpLimbs+2;
+
+  if (limbs>HP_LIMBS_MAX) limbs=HP_LIMBS_MAX;
+  if (limbs<hp_prec) limbs=hp_prec;
+  return limbs;
+}
+
+//Cached constant cut to hp_prec
+static void HpConst(unsigned char *result, const unsigned char *cell)
+{
+  struct HpHeadType head;
+
+  HpCopy(result,cell);
+  HpHead(&head,result);
+  if (head.len>hp_prec) HpSetHead(result,head.sign,hp_prec,head.exp);
+}
+
+//Gauss-Legendre in T5-T9. Digits double every pass
+static void HpPi(unsigned char *result)
+{
+  struct HpHeadType ha,hd;
+  unsigned char *a=HP_T(6),*b=HP_T(7),*t=HP_T(8),*next=HP_T(9),*diff=HP_T(5),*temp;
+  unsigned int i,p=1;
+  int prec=hp_prec;
+
+  if (hp_pi_limbs>=hp_prec)
+  {
+    HpConst(result,hp_pi);
+    return;
+  }
+
+  hp_prec=HpConstLimbs();
+  HpCopy(a,hp_one);
+  HpSetInt(next,2,0);
+  HpRsqrt(b,next);
+  HpSetInt(t,2500,-1);
+  for (i=0;i<HP_PI_STEPS;i++)
+  {
+    HpSum(next,a,b,0);
+    HpDivSmall(next,next,2);
+    HpMult(b,a,b);
+    HpSqrt(b,b);
+    HpSum(diff,a,next,1);
+    HpMult(diff,diff,diff);
+    HpMulSmall(diff,diff,p);
+    HpSum(t,t,diff,1);
+    temp=a;
+    a=next;
+    next=temp;
+    p*=2;
+    HpSum(diff,a,b,1);
+    HpHead(&hd,diff);
+    HpHead(&ha,a);
+    if ((hd.len==0)||((ha.exp-hd.exp)>hp_prec/2)) break;
+  }
+  HpSum(diff,a,b,0);
+  HpMult(diff,diff,diff);
+  HpMulSmall(t,t,4);
+  HpDiv(hp_pi,diff,t);
+  hp_pi_limbs=hp_prec;
+  hp_prec=prec;
+  HpConst(result,hp_pi);
+}
+
+//ln(2^m)=pi/(2*AGM(1,4/2^m)) once 2^m>LIMB_BASE^(limbs/2), then divided by m.
+//T10-T12
+static void HpLn2(unsigned char *result)
+{
+  struct HpHeadType head;
+  unsigned char *power=HP_T(10),*z=HP_T(11),*g=HP_T(12);
+  int count=0,prec=hp_prec;
+
+  if (hp_ln2_limbs>=hp_prec)
+  {
+    HpConst(result,hp_ln2);
+    return;
+  }
+
+  hp_prec=HpConstLimbs();
+  HpCopy(power,hp_one);
+  do
+  {
+    HpMulSmall(power,power,HP_LN_SCALE);
+    count++;
+    HpHead(&head,power);
+  } while (head.exp<(hp_prec/2+1));
+
+  HpRecip(z,power);
+  HpMulSmall(z,z,4);
+  HpAgm(g,hp_one,z);
+  HpPi(power);
+  HpDiv(z,power,g);
+  HpDivSmall(z,z,2*HP_LN_BITS);
+  HpDivSmall(hp_ln2,z,count);
+  hp_ln2_limbs=hp_prec;
+  hp_prec=prec;
+  HpConst(result,hp_ln2);
+}
+
+//ln(s)=pi/(2*AGM(1,4/s)) to all the limbs once s>LIMB_BASE^(limbs/2)
+//x is scaled up to s=x*2^m so ln(x)=pi/(2*AGM(1,4/s))-m*ln(2). One extra limb
+//covers the digits lost subtracting the two as long as x isn't within
+//1/LIMB_BASE of 1. Closer than that HpLnNear does it. T10-T14. False if x<=0
+//or so small m doesn't fit HpMulSmall
+static bool HpLn(unsigned char *result, const unsigned char *x)
+{
+  struct HpHeadType head;
+  unsigned char *s=HP_T(10),*z=HP_T(11),*g=HP_T(12),*t=HP_T(13),*ln2=HP_T(14);
+  int count=0,prec=hp_prec;
+
+  HpHead(&head,x);
+  if ((head.len==0)||(head.sign)) return false;
+
+  hp_prec++;
+  HpSum(s,x,hp_one,1);
+  HpHead(&head,s);
+  if (head.len==0)
+  {
+    HpSetHead(result,0,0,0);
+    hp_prec=prec;
+    return true;
+  }
+  if (head.exp<0)
+  {
+    HpLnNear(result,x,s);
+    hp_prec=prec;
+    return true;
+  }
+
+  HpHead(&head,x);
+  HpLn2(ln2);
+  HpCopy(s,x);
+  while (head.exp<(hp_prec/2+1))
+  {
+    if (count==(LIMB_BASE-1))
+    {
+      hp_prec=prec;
+      return false;
+    }
+    HpMulSmall(s,s,HP_LN_SCALE);
+    count++;
+    HpHead(&head,s);
+  }
+
+  HpRecip(z,s);
+  HpMulSmall(z,z,4);
+  HpAgm(g,hp_one,z);
+  HpPi(t);
+  HpDiv(z,t,g);
+  HpDivSmall(z,z,2);
+  if (count)
+  {
+    HpMulSmall(t,ln2,HP_LN_BITS);
+    HpMulSmall(t,t,count);
+    HpSum(z,z,t,1);
+  }
+  HpCopy(result,z);
+  hp_prec=prec;
+  return true;
+}
+
+//ln(x)=2*atanh(u)=2*(u+u^3/3+u^5/5...) with u=(x-1)/(x+1). d is x-1 and is
+//under 1/LIMB_BASE so each term is 8 digits smaller and nothing cancels.
+//T10-T14
+static void HpLnNear(unsigned char *result, const unsigned char *x, const unsigned char *d)
+{
+  struct HpHeadType hs,ht;
+  //d is done with once u is worked out so its T10 holds each term over k
+  unsigned char *q=HP_T(10),*u=HP_T(11),*u2=HP_T(12),*term=HP_T(13),*sum=HP_T(14);
+  unsigned int k;
+
+  HpSum(term,x,hp_one,0);
+  HpDiv(u,d,term);
+  HpMult(u2,u,u);
+  HpCopy(sum,u);
+  HpCopy(term,u);
+  HpHead(&hs,sum);
+  for (k=3;;k+=2)
+  {
+    HpMult(term,term,u2);
+    HpDivSmall(q,term,k);
+    HpHead(&ht,q);
+    if ((ht.len==0)||((hs.exp-ht.exp)>hp_prec)) break;
+    HpSum(sum,sum,q,0);
+  }
+  HpMulSmall(result,sum,2);
+}
+
+//Newton on HpLn: y=y+y*(x-ln(y)). The first guess comes from ExpBCD on x
+//less a whole number of ln(10)s so it has WorkPlaces digits whatever the size
+//of the result. T15-T16. False if x is too large for the stack
+static bool HpExp(unsigned char *result, const unsigned char *x)
+{
+  struct HpHeadType head;
+  unsigned char *y=HP_T(15),*t=HP_T(16);
+  int i,k=0,count,steps[HP_STEPS],prec=hp_prec;
+
+  if (!HpToBCD(p3,x,Settings.WorkPlaces)) return false;
+  FullShrinkBCD_RAM(p3);
+  if (p3[BCD_DEC]==0) PadBCD_RAM(p3,1);
+  //past 177 either way is more than the stack can hold
+  i=p3[BCD_SIGN];
+  p3[BCD_SIGN]=0;
+  if (CompBCD_RAM("177",p3)!=COMP_GT) return false;
+  p3[BCD_SIGN]=i;
+
+  DivBCD(p4,p3,perm_log10);
+  RoundBCD(p4,0);
+  for (i=0;i<p4[BCD_DEC];i++) k=k*10+p4[i+3];
+  if (k)
+  {
+    if (p4[BCD_SIGN]) k=-k;
+    MultBCD(p5,p4,perm_log10);
+    SubBCD(p5,p3,p5);
+  }
+  else CopyBCD_ItI(p5,p3);
+  ExpBCD(p4,p5);
+  HpFromBCD(y,p4);
+
+  //times 10^k
+  HpHead(&head,y);
+  i=k%LIMB_DIGITS;
+  if (i<0) i+=LIMB_DIGITS;
+  HpSetHead(y,head.sign,head.len,head.exp+(k-i)/LIMB_DIGITS);
+  for (;i;i--) HpMulSmall(y,y,10);
+
+  count=HpSteps(steps,prec);
+  for (i=0;i<count;i++)
+  {
+    hp_prec=steps[i];
+    HpLn(t,y);
+    HpSum(t,x,t,1);
+    HpMult(t,t,y);
+    HpSum(y,y,t,0);
+  }
+  hp_prec=prec;
+  HpCopy(result,y);
+  return true;
+}
+
+//BCD is internal. Digits are padded in front so the decimal point falls on a
+//limb boundary
+static void HpFromBCD(unsigned char *cell, const unsigned char *BCD)
+{
+  int i,first,e10,pad,count=0,limb=0,digits=0;
+
+  for (first=0;first<BCD[BCD_LEN];first++) if (BCD[first+3]) break;
+  if (first==BCD[BCD_LEN])
+  {
+    HpSetHead(cell,0,0,0);
+    return;
+  }
+  e10=BCD[BCD_DEC]-first;
+  pad=(LIMB_DIGITS-e10%LIMB_DIGITS)%LIMB_DIGITS;
+
+  for (i=first-pad;i<BCD[BCD_LEN];i++)
+  {
+    if (i<first) limb*=10;
+    else limb=limb*10+BCD[i+3];
+    digits++;
+    if (digits==LIMB_DIGITS)
+    {
+      hp_wp[count++]=limb;
+      limb=0;
+      digits=0;
+    }
+  }
+  if (digits)
+  {
+    for (;digits<LIMB_DIGITS;digits++) limb*=10;
+    hp_wp[count++]=limb;
+  }
+  HpStore(cell,0,hp_wp,count);
+  HpSetHead(cell,BCD[BCD_SIGN],count,(e10+pad)/LIMB_DIGITS);
+}
+
+//BCD is internal. Rounded to places decimals. False if it doesn't fit a cell
+static bool HpToBCD(unsigned char *BCD, const unsigned char *cell, int places)
+{
+  struct HpHeadType head;
+  int i,j,len=0,skip=0,whole,total;
+  unsigned int limb;
+
+  HpHead(&head,cell);
+  BCD[BCD_SIGN]=head.sign;
+  whole=LIMB_DIGITS*head.exp;
+  if (whole<0)
+  {
+    skip=-whole;
+    whole=0;
+  }
+  //one digit to round on and room for RoundBCD to carry into a new one
+  total=whole+places+1;
+  if (total>MATH_CELL_SIZE-4) return false;
+
+  BCD[BCD_DEC]=whole;
+  for (;(len<skip)&&(len<total);len++) BCD[len+3]=0;
+  for (i=0;len<total;i++)
+  {
+    if ((i%HP_WINDOW)==0) HpLoad(hp_wa,cell,head.len,i,HP_WINDOW);
+    limb=hp_wa[i%HP_WINDOW];
+    for (j=1000;(j)&&(len<total);j/=10)
+    {
+      BCD[len+3]=(limb/j)%10;
+      len++;
+    }
+  }
+  BCD[BCD_LEN]=len;
+  RoundBCD(BCD,places);
+  return true;
+}
+
+//Rounds half up to digits significant digits
+static void HpRound(unsigned char *dest, const unsigned char *src, int digits)
+{
+  struct HpHeadType head;
+  int i,last,unit=1;
+  unsigned int value,round;
+
+  HpHead(&head,src);
+  HpCopy(dest,src);
+  if (head.len==0) return;
+
+  //absolute position of the last digit kept counting limb 0's leading zeros
+  HpLoad(hp_wa,src,head.len,0,1);
+  last=digits-1;
+  for (i=1000;hp_wa[0]<i;i/=10) last++;
+  if ((last/LIMB_DIGITS)>=head.len) return;
+
+  for (i=last%LIMB_DIGITS;i<(LIMB_DIGITS-1);i++) unit*=10;
+  last/=LIMB_DIGITS;
+  HpLoad(hp_wa,src,head.len,last,2);
+  if (unit>1) round=(hp_wa[0]/(unit/10))%10;
+  else round=hp_wa[1]/1000;
+  value=hp_wa[0]-hp_wa[0]%unit;
+  if (round>=5) value+=unit;
+  head.len=last+1;
+
+  for (i=last;value>=LIMB_BASE;)
+  {
+    hp_wa[0]=value-LIMB_BASE;
+    HpStore(dest,i,hp_wa,1);
+    i--;
+    if (i<0) break;
+    HpLoad(hp_wa,dest,head.len,i,1);
+    value=hp_wa[0]+1;
+  }
+  if (i<0)
+  {
+    //all 9s
+    if (head.len<hp_prec) head.len++;
+    HpShiftDown(dest,head.len,1);
+    head.exp++;
+  }
+  else
+  {
+    hp_wa[0]=value;
+    HpStore(dest,i,hp_wa,1);
+  }
+  HpSetHead(dest,head.sign,head.len,head.exp);
+}
+
+//var is external???
+static unsigned char CompBCD(const char *num, unsigned char *var)
+{
+  ImmedBCD_RAM(num,p0);
+  CopyBCD_EtI(local_buff1,var);
+  return CompVarBCD_ItI(p0,local_buff1);
+}
+
+static unsigned char CompBCD_RAM(const char *num, unsigned char *var)
+{
+  ImmedBCD_RAM(num,p0);
+  return CompVarBCD_ItI(p0,var);
+}
+
+//Digits are lined up on the decimal point and compared most significant
+//first, stopping at the first that decides it. Most compares are over after a
+//digit or two where a subtraction would have to go through all of them
+static unsigned char CompVarBCD_ItI(const unsigned char *var1, const unsigned char *var2)
+{
+  int i,end,start1,start2;
+  unsigned char digit1,digit2,sign1,sign2;
+
+  i=var1[BCD_DEC];
+  if (var2[BCD_DEC]>i) i=var2[BCD_DEC];
+  start1=i-var1[BCD_DEC];
+  start2=i-var2[BCD_DEC];
+  end=start1+var1[BCD_LEN];
+  if ((start2+var2[BCD_LEN])>end) end=start2+var2[BCD_LEN];
+  sign1=var1[BCD_SIGN];
+  sign2=var2[BCD_SIGN];
+
+  for (i=0;i<end;i++)
+  {
+    digit1=0;
+    if ((i>=start1)&&(i<(start1+var1[BCD_LEN]))) digit1=var1[i-start1+3];
+    digit2=0;
+    if ((i>=start2)&&(i<(start2+var2[BCD_LEN]))) digit2=var2[i-start2+3];
+    if (sign1!=sign2)
+    {
+      //first non-zero digit says which isn't zero and so which is bigger
+      if (digit1) return sign1?COMP_LT:COMP_GT;
+      if (digit2) return sign2?COMP_GT:COMP_LT;
+    }
+    else if (digit1!=digit2)
+    {
+      if ((digit1>digit2)==(sign1==0)) return COMP_GT;
+      return COMP_LT;
+    }
+  }
+  return COMP_EQ;
+}
+
+
+
+//convert angle to 0-90 format and put in p3
+static unsigned char TrigPrep(unsigned int stack_ptr_copy,int *cosine)
+{
+  int sine;
+
+  if (Settings.DegRad) CopyBCD_EtI(p3,BCD_stack+(stack_ptr_copy-1)*MATH_CELL_SIZE);
+  else
+  {
+    //p1 should be free?
+    CopyBCD_EtI(p1,BCD_stack+(stack_ptr_copy-1)*MATH_CELL_SIZE);
+    MultBCD(p3,p1,perm_deg);
+  }
+
+  ImmedBCD_RAM("360",p2);
+  while(CompVarBCD_ItI(p3,p2)==COMP_GT) SubBCD(p3,p3,p2);
+
+  if (CompBCD_RAM("180",p3)==COMP_LT)
+  {
+    SubBCD(stack_buffer,p2,p3);
+    sine=1;
+  }
+  else
+  {
+    CopyBCD_ItI(stack_buffer,p3);
+    sine=0;
+  }
+  if (CompBCD_RAM("90",stack_buffer)==COMP_LT)
+  {
+    ImmedBCD_RAM("180",p2);
+    SubBCD(p3,p2,stack_buffer);
+    *cosine=1;
+  }
+  else
+  {
+    CopyBCD_ItI(p3,stack_buffer);
+    *cosine=0;
+  }
+
+  return sine;
+}
+
+//Cheap check so most entries can be skipped without comparing every digit
+static unsigned char CacheCheck(unsigned char *arg1, unsigned char *arg2)
+{
+  int i,i_end;
+  unsigned char check=0;
+
+  i_end=arg1[BCD_LEN]+3;
+  for (i=0;i<i_end;i++) check=check*3+arg1[i];
+  if (arg2)
+  {
+    i_end=arg2[BCD_LEN]+3;
+    for (i=0;i<i_end;i++) check=check*3+arg2[i];
+  }
+  return check;
+}
+
+static bool CacheMatch(unsigned char *cell, unsigned char *var)
+{
+  int i,i_end;
+  i_end=var[BCD_LEN]+3;
+  RAM_ReadBlock(ext_buff,cell,i_end);
+  for (i=0;i<i_end;i++) if (ext_buff[i]!=var[i]) return false;
+  return true;
+}
+
+//arg2 is only for PowBCD and result2 only for TanBCD. Pass 0 otherwise
+static bool CacheLookup(unsigned char op, unsigned char *arg1, unsigned char *arg2, unsigned char *result, unsigned char *result2)
+{
+  int i,entry;
+  unsigned char check;
+
+  cache_lookups++;
+  check=CacheCheck(arg1,arg2);
+  for (i=0;i<CACHE_SIZE;i++)
+  {
+    entry=i*CACHE_ENTRY_SIZE;
+    if (calc_cache[entry]!=op) continue;
+    if (calc_cache[entry+1]!=Settings.DecPlaces) continue;
+    if (calc_cache[entry+2]!=Settings.DegRad) continue;
+    if (calc_cache[entry+3]!=check) continue;
+    if (!CacheMatch(calc_cache+entry+CACHE_HEADER,arg1)) continue;
+    if ((arg2)&&(!CacheMatch(calc_cache+entry+CACHE_HEADER+MATH_CELL_SIZE,arg2))) continue;
+
+    if (result2) CopyBCD_EtI(result2,calc_cache+entry+CACHE_HEADER+MATH_CELL_SIZE);
+    CopyBCD_EtI(result,calc_cache+entry+CACHE_HEADER+2*MATH_CELL_SIZE);
+    cache_hits++;
+    return true;
+  }
+  return false;
+}
+
+//Oldest entry is replaced
+static void CacheStore(unsigned char op, unsigned char *arg1, unsigned char *arg2, unsigned char *result, unsigned char *result2)
+{
+  int entry;
+
+  //interrupted result is garbage
+  if (idle_abort) return;
+
+  entry=cache_next*CACHE_ENTRY_SIZE;
+  calc_cache[entry]=op;
+  calc_cache[entry+1]=Settings.DecPlaces;
+  calc_cache[entry+2]=Settings.DegRad;
+  calc_cache[entry+3]=CacheCheck(arg1,arg2);
+  CopyBCD_ItE(calc_cache+entry+CACHE_HEADER,arg1);
+  if (arg2) CopyBCD_ItE(calc_cache+entry+CACHE_HEADER+MATH_CELL_SIZE,arg2);
+  else if (result2) CopyBCD_ItE(calc_cache+entry+CACHE_HEADER+MATH_CELL_SIZE,result2);
+  CopyBCD_ItE(calc_cache+entry+CACHE_HEADER+2*MATH_CELL_SIZE,result);
+
+  cache_next++;
+  if (cache_next==CACHE_SIZE) cache_next=0;
+}
+
+//Number of stack arguments for keys that give a quick result first
+static unsigned char RefineArgs(unsigned char key)
+{
+  switch (key)
+  {
+    case KEY_POW:
+    case KEY_XRTY:
+      return 2;
+    case KEY_EX:
+    case KEY_10X:
+    case KEY_LN:
+    case KEY_LOG:
+    case KEY_SQRT:
+    case KEY_SIN:
+    case KEY_COS:
+    case KEY_TAN:
+    case KEY_ASIN:
+    case KEY_ACOS:
+    case KEY_ATAN:
+    case KEY_SINH:
+    case KEY_COSH:
+    case KEY_TANH:
+    case KEY_ASINH:
+    case KEY_ACOSH:
+    case KEY_ATANH:
+      return 1;
+  }
+  return 0;
+}
+
+//Keys that only change the input line
+static bool InputEditKey(int key)
+{
+  switch (key)
+  {
+    case KEY_BACKSPACE:
+    case KEY_DELETE:
+    case KEY_LEFT:
+    case KEY_RIGHT:
+    case KEY_ESCAPE:
+    case KEY_CLEAR:
+    case KEY_DOWN:
+    case KEY_UP:
+      return true;
+  }
+  return false;
+}
+
+//Puts the arguments of the quick result back so its key can run again
+//at full precision. Background refining stops when a key is pressed
+static void RefineStart(bool input, bool background)
+{
+  int i;
+
+  //input line is in p0 which the math functions use
+  if (input) for (i=0;i<MATH_CELL_SIZE;i++) refine_cells[REFINE_INPUT+i]=p0[i];
+  for (i=0;i<refine_args;i++) CopyBCD(BCD_stack+(refine_level+i)*MATH_CELL_SIZE,refine_cells+i*MATH_CELL_SIZE);
+  stack_ptr[which_stack]=refine_level+refine_args;
+  refining=true;
+  idle_abort=false;
+  idle_poll=background;
+}
+
+//Checked in the long loops so a key press ends idle time work quickly
+static bool IdleAbort()
+{
+  if ((idle_poll)&&(!idle_abort)) idle_abort=KeyWaiting();
+  return idle_abort;
+}
+
+static unsigned char SpecIndex(unsigned char key)
+{
+  unsigned char i;
+  for (i=0;i<SPEC_KEYS;i++)
+  {
+    if (SpecKeys[i]==key) break;
+  }
+  return i;
+}
+
+//Most used key not yet worked out for this stack. SPEC_KEYS if none
+static unsigned char SpecNext()
+{
+  unsigned char i,best=SPEC_KEYS;
+
+  if (stack_ptr[which_stack]==0) return SPEC_KEYS;
+  for (i=0;i<SPEC_KEYS;i++)
+  {
+    if ((spec_version[i]==stack_version)||(key_count[i]==0)) continue;
+    if ((best==SPEC_KEYS)||(key_count[i]>key_count[best])) best=i;
+  }
+  return best;
+}
+
+//Runs the key on X then puts X back. Stops when a key is pressed
+static void SpecStart(unsigned char index)
+{
+  CopyBCD(spec_cells+SPEC_X,BCD_stack+(stack_ptr[which_stack]-1)*MATH_CELL_SIZE);
+  spec_index=index;
+  speculating=true;
+  spec_failed=false;
+  idle_abort=false;
+  idle_poll=true;
+}
+
+//Node for the cell at level or -1
+static int LazyFind(int level)
+{
+  int i;
+
+  for (i=0;i<LAZY_NODES;i++)
+  {
+    if ((lazy[i].op!=LAZY_NONE)&&(lazy[i].level==level)) return i;
+  }
+  return -1;
+}
+
+//Free node, working out the lowest one on the stack if they're all in use
+static int LazyNew(int level, unsigned char op)
+{
+  int i,slot=-1;
+
+  for (i=0;i<LAZY_NODES;i++)
+  {
+    if (lazy[i].op==LAZY_NONE)
+    {
+      slot=i;
+      break;
+    }
+    if ((slot==-1)||(lazy[i].level<lazy[slot].level)) slot=i;
+  }
+  if (lazy[slot].op!=LAZY_NONE) LazyForce(slot);
+  lazy[slot].op=op;
+  lazy[slot].level=level;
+  return slot;
+}
+
+//Replaces the operand in the stack with the result the same way the key
+//would have. Arguments were checked when the node was made
+static void LazyForce(int slot)
+{
+  unsigned char *cell=BCD_stack+lazy[slot].level*MATH_CELL_SIZE;
+
+  switch (lazy[slot].op)
+  {
+    case LAZY_SQUARE:
+      CopyBCD_EtI(p0,cell);
+      if (!ShortMathBCD('*',stack_buffer,p0,p0)) SquareBCD(stack_buffer,p0);
+      break;
+    case LAZY_SUMSQ:
+      CopyBCD_EtI(p0,cell);
+      CopyBCD_EtI(p1,lazy_cells+slot*MATH_CELL_SIZE);
+      SquareBCD(p2,p0);
+      SquareBCD(p3,p1);
+      AddBCD(stack_buffer,p2,p3);
+      break;
+    case LAZY_MULT:
+      CopyBCD_EtI(p0,cell);
+      CopyBCD_EtI(p1,lazy_cells+slot*MATH_CELL_SIZE);
+      if (!ShortMathBCD('*',stack_buffer,p0,p1)) MultBCD(stack_buffer,p0,p1);
+      break;
+    case LAZY_LN:
+      CopyBCD_EtI(local_buff1,cell);
+      lazy[slot].op=LAZY_NONE;
+      //out of range leaves x like the key does
+      if (!LnBCD(stack_buffer,local_buff1))
+      {
+        ErrorMsg("Invalid input");
+        return;
+      }
+      break;
+    case LAZY_EXP:
+      CopyBCD_EtI(local_buff1,cell);
+      ExpBCD(stack_buffer,local_buff1);
+      break;
+    default:
+      return;
+  }
+  RoundBCD(stack_buffer,Settings.DecPlaces);
+  CommitBCD(cell,stack_buffer);
+  lazy[slot].op=LAZY_NONE;
+}
+
+static void LazyForceAll()
+{
+  int i;
+
+  for (i=0;i<LAZY_NODES;i++) LazyForce(i);
+}
+
+//True if the key undoing op on x gives x back without an error on the way.
+//e^x for x over -10 doesn't round to 0 for ln even at 6 places. LnBCD works
+//x down to 1 without losing it to 0 when x or 1/x has 16 whole digits or
+//less, which also keeps ln(x) well under 177 for e^x
+static bool LazyInverse(unsigned char op, unsigned char *cell)
+{
+  int i;
+
+  CopyBCD_EtI(local_buff1,cell);
+  if (op==LAZY_EXP) return (local_buff1[BCD_SIGN]==0)||(local_buff1[BCD_DEC]==1);
+  if ((local_buff1[BCD_DEC]>1)||(local_buff1[3])) return local_buff1[BCD_DEC]<=16;
+  //1/x for 0.0...0d has at most one whole digit more than the places up to d
+  for (i=4;i<local_buff1[BCD_LEN]+3;i++) if (local_buff1[i]) break;
+  return (i-2)<=16;
+}
+
+//Called for each key while a program runs. True if the key was taken care of
+//here by making a node or fusing it with the ones there. Otherwise every
+//node is worked out so the key sees plain numbers
+static bool LazyKey(int key)
+{
+  int top=stack_ptr[which_stack]-1;
+  int slot,slot2;
+  unsigned char *cell=BCD_stack+top*MATH_CELL_SIZE;
+
+  switch (key)
+  {
+    case KEY_X2:
+      if (top<0) break;
+      slot=LazyFind(top);
+      if (slot>=0) LazyForce(slot);
+      LazyNew(top,LAZY_SQUARE);
+      return true;
+    case KEY_SQRT:
+      if (top<0) break;
+      slot=LazyFind(top);
+      if (slot<0) break;
+      if (lazy[slot].op==LAZY_SQUARE)
+      {
+        //sqrt(x^2) is |x|
+        BCD_stack[top*MATH_CELL_SIZE+BCD_SIGN]=0;
+        lazy[slot].op=LAZY_NONE;
+        return true;
+      }
+      if (lazy[slot].op==LAZY_SUMSQ)
+      {
+        CopyBCD_EtI(local_buff1,cell);
+        CopyBCD_EtI(local_buff2,lazy_cells+slot*MATH_CELL_SIZE);
+        HypotBCD(stack_buffer,local_buff1,local_buff2);
+        RoundBCD(stack_buffer,Settings.DecPlaces);
+        CommitBCD(cell,stack_buffer);
+        lazy[slot].op=LAZY_NONE;
+        return true;
+      }
+      break;
+    case KEY_LN:
+    case KEY_EX:
+      if (top<0) break;
+      slot=LazyFind(top);
+      if ((slot>=0)&&(lazy[slot].op==((key==KEY_LN)?LAZY_EXP:LAZY_LN))&&
+          (LazyInverse(lazy[slot].op,cell)))
+      {
+        //ln(e^x) and e^ln(x) are x which is still in the cell
+        lazy[slot].op=LAZY_NONE;
+        return true;
+      }
+      if (slot>=0) LazyForce(slot);
+      //bad arguments go through the key so it can complain
+      if (key==KEY_LN)
+      {
+        if (IsZero(cell)||(BCD_stack[top*MATH_CELL_SIZE+BCD_SIGN]==1)) break;
+        LazyNew(top,LAZY_LN);
+      }
+      else
+      {
+        if (CompBCD("177",cell)!=COMP_GT) break;
+        LazyNew(top,LAZY_EXP);
+      }
+      return true;
+    case '*':
+      if (top<1) break;
+      slot=LazyFind(top);
+      if (slot>=0) LazyForce(slot);
+      slot=LazyFind(top-1);
+      if (slot>=0) LazyForce(slot);
+      slot=LazyNew(top-1,LAZY_MULT);
+      CopyBCD(lazy_cells+slot*MATH_CELL_SIZE,cell);
+      stack_ptr[which_stack]--;
+      return true;
+    case '+':
+    case '-':
+      if (top<1) break;
+      slot=LazyFind(top-1);
+      slot2=LazyFind(top);
+      if ((key=='+')&&(slot>=0)&&(slot2>=0)&&
+          (lazy[slot].op==LAZY_SQUARE)&&(lazy[slot2].op==LAZY_SQUARE))
+      {
+        lazy[slot].op=LAZY_SUMSQ;
+        lazy[slot2].op=LAZY_NONE;
+        CopyBCD(lazy_cells+slot*MATH_CELL_SIZE,cell);
+        stack_ptr[which_stack]--;
+        return true;
+      }
+      //a*b+c and c+a*b with one rounding
+      if ((slot>=0)&&(slot2<0)&&(lazy[slot].op==LAZY_MULT))
+      {
+        CopyBCD_EtI(p3,cell);
+      }
+      else if ((slot2>=0)&&(slot<0)&&(lazy[slot2].op==LAZY_MULT))
+      {
+        CopyBCD_EtI(p3,cell-MATH_CELL_SIZE);
+        slot=slot2;
+      }
+      else break;
+      CopyBCD_EtI(p0,BCD_stack+lazy[slot].level*MATH_CELL_SIZE);
+      CopyBCD_EtI(p1,lazy_cells+slot*MATH_CELL_SIZE);
+      if (!ShortMathBCD('*',p2,p0,p1)) MultBCD(p2,p0,p1);
+      if (slot==slot2) SumBCD(stack_buffer,p3,p2,key=='-');
+      else SumBCD(stack_buffer,p2,p3,key=='-');
+      lazy[slot].op=LAZY_NONE;
+      stack_ptr[which_stack]--;
+      RoundBCD(stack_buffer,Settings.DecPlaces);
+      CommitBCD(cell-MATH_CELL_SIZE,stack_buffer);
+      return true;
   }
-
-  return sine;
+  LazyForceAll();
+  return false;
 }
 
 static int ProgLine(int prog, int line, int start, bool fill_buff)
@@ -3770,6 +6210,12 @@ static int ProgLine(int prog, int line, int start, bool fill_buff)
       case KEY_TAN:
       case KEY_ATAN:
       case KEY_X2:
+      case KEY_SINH:
+      case KEY_COSH:
+      case KEY_TANH:
+      case KEY_ASINH:
+      case KEY_ACOSH:
+      case KEY_ATANH:
       case KEY_ENTER:
       case KEY_SIGN:
       case KEY_INS:
@@ -3874,6 +6320,12 @@ static void ProgLineFill(unsigned char *buffer)
   else if (p0[0]==KEY_TAN) ProgLineFillCopy(buffer,"tan");
   else if (p0[0]==KEY_ATAN) ProgLineFillCopy(buffer,"atan");
   else if (p0[0]==KEY_X2) ProgLineFillCopy(buffer,"x^2");
+  else if (p0[0]==KEY_SINH) ProgLineFillCopy(buffer,"sinh");
+  else if (p0[0]==KEY_COSH) ProgLineFillCopy(buffer,"cosh");
+  else if (p0[0]==KEY_TANH) ProgLineFillCopy(buffer,"tanh");
+  else if (p0[0]==KEY_ASINH) ProgLineFillCopy(buffer,"asinh");
+  else if (p0[0]==KEY_ACOSH) ProgLineFillCopy(buffer,"acosh");
+  else if (p0[0]==KEY_ATANH) ProgLineFillCopy(buffer,"atanh");
   else if (p0[0]==KEY_SIGN) ProgLineFillCopy(buffer,"+/-");
   else
   {
@@ -3893,7 +6345,7 @@ static void ProgLineFillCopy(unsigned char *buffer, const char *msg)
 
 void DrawStack(bool menu, bool input, int stack_pointer)
 {
-  int i,j=4,k,k_end,l,m;
+  int i,j=4,k,slot;
   if (menu) j--;
   if (input) j--;
   for (i=0;i<j;i++)
@@ -3903,136 +6355,189 @@ void DrawStack(bool menu, bool input, int stack_pointer)
     putchar(':');
     if ((stack_pointer-j+i)>=0)
     {
-      //This should be done at the end of all calculations
-      //FullShrinkBCD(BCD_stack+(stack_pointer-j+i)*MATH_CELL_SIZE);
-      if (BCD_stack[(stack_pointer-j+i)*MATH_CELL_SIZE+BCD_DEC]==0)
-      {
-        PadBCD(BCD_stack+(stack_pointer-j+i)*MATH_CELL_SIZE,1);
-      }
-      //CopyBCD(p1,BCD_stack+(stack_pointer-j+i)*MATH_CELL_SIZE);
-      CopyBCD_EtI(p1,BCD_stack+(stack_pointer-j+i)*MATH_CELL_SIZE);
+      slot=DrawSlot(stack_pointer-j+i,stack_pointer-j,stack_pointer-1);
+      for (k=2;k<SCREEN_WIDTH;k++) putchar(draw_cache[slot].text[k]);
+    }
+  }
+}
 
-      if (Settings.SciNot)
-      {
-        if (IsZero_RAM(p1)) LCD_Text("0.e0");
-        else
-        {
-          //printf("*");
-          //PrintBCD(p1,-1);
-          k=0;
-          for (l=0;l<p1[BCD_LEN];l++) if (p1[l+3]) k=l;
-          p1[BCD_LEN]=k+1;
-          //printf("!");
-          //PrintBCD(p1,-1);
-          //printf("*");
-          //getch();
-
-          for (l=0;l<p1[BCD_LEN];l++) if (p1[l+3]!=0) break;
-
-          m=0;
-          k=(p1[BCD_DEC]-l-1);//length of e
-          if (k<0) k=-k;
-          if (p1[BCD_SIGN]) m++;
-          if (k>9) m++;
-          if (k>99) m++;
-          if ((p1[BCD_DEC]-l-1)<0) m++;
-
-          //if ((16-m)>(p1[BCD_LEN]-l))
-          if (((SCREEN_WIDTH-4)-m)>(p1[BCD_LEN]-l))
-          {
-            k_end=p1[BCD_LEN]-l;
-            m=(SCREEN_WIDTH-3)-k_end-m;
-          }
-          else
-          {
-            k_end=(SCREEN_WIDTH-5)-m;
-            m=2;
-          }
+//Slot with the row for level, formatting it if it isn't there. Free slots are
+//used first then ones for levels outside low..high since they aren't on
+//screen. low is below 0 when the stack doesn't fill the screen
+static int DrawSlot(int level, int low, int high)
+{
+  int i,slot=-1;
 
-          gotoxy(m,i);
-          if (p1[BCD_SIGN]) putchar('-');
-          for (k=0;k<k_end;k++)
-          {
-            putchar(p1[k+l+3]+'0');
-            if (k==0) putchar('.');
-          }
+  if (low<0) low=0;
+  for (i=0;i<SCREEN_ROWS;i++)
+  {
+    if (draw_cache[i].level==level)
+    {
+      if ((draw_cache[i].sci==Settings.SciNot)&&(draw_cache[i].places==Settings.DecPlaces)) return i;
+      slot=i;
+      break;
+    }
+  }
+  for (i=0;(slot<0)&&(i<SCREEN_ROWS);i++)
+  {
+    if (draw_cache[i].level==-1) slot=i;
+  }
+  for (i=0;(slot<0)&&(i<SCREEN_ROWS);i++)
+  {
+    if ((draw_cache[i].level<low)||(draw_cache[i].level>high)) slot=i;
+  }
+  //rows on screen never need more slots than there are
+  if (slot<0) slot=0;
+  draw_cache[slot].level=level;
+  draw_cache[slot].sci=Settings.SciNot;
+  draw_cache[slot].places=Settings.DecPlaces;
+  DrawFormat(draw_cache[slot].text,level);
+  return slot;
+}
 
-          putchar('e');
-          k=p1[BCD_DEC]-l-1;
-          if (k<0)
-          {
-            putchar('-');
-            k=-k;
-          }
-          m=0;
-          if (k/100) {putchar('0'+(k/100));m=1;}
-          if (((k%100)/10)||m) {putchar('0'+(k%100)/10);m=1;}
-          putchar('0'+k%10);
+//Row for a stack level by column with the first 2 left for the level number
+static void DrawFormat(char *text, int level)
+{
+  int i,k,k_end,l,m,pos;
 
-          //printf("Len: %d\n",x1[BCD_LEN]-i);
-          //printf("E: %d\n",x1[BCD_DEC]-i-1);
-        }
+  for (i=0;i<SCREEN_WIDTH;i++) text[i]=' ';
+  //CommitBCD already normalized the cell
+  CopyBCD_EtI(p1,BCD_stack+level*MATH_CELL_SIZE);
+
+  if (Settings.SciNot)
+  {
+    if (IsZero_RAM(p1))
+    {
+      text[2]='0';
+      text[3]='.';
+      text[4]='e';
+      text[5]='0';
+    }
+    else
+    {
+      //printf("*");
+      //PrintBCD(p1,-1);
+      k=0;
+      for (l=0;l<p1[BCD_LEN];l++) if (p1[l+3]) k=l;
+      p1[BCD_LEN]=k+1;
+      //printf("!");
+      //PrintBCD(p1,-1);
+      //printf("*");
+      //getch();
+
+      for (l=0;l<p1[BCD_LEN];l++) if (p1[l+3]!=0) break;
+
+      m=0;
+      k=(p1[BCD_DEC]-l-1);//length of e
+      if (k<0) k=-k;
+      if (p1[BCD_SIGN]) m++;
+      if (k>9) m++;
+      if (k>99) m++;
+      if ((p1[BCD_DEC]-l-1)<0) m++;
+
+      //if ((16-m)>(p1[BCD_LEN]-l))
+      if (((SCREEN_WIDTH-4)-m)>(p1[BCD_LEN]-l))
+      {
+        k_end=p1[BCD_LEN]-l;
+        m=(SCREEN_WIDTH-3)-k_end-m;
       }
       else
       {
-        k=p1[BCD_LEN];
+        k_end=(SCREEN_WIDTH-5)-m;
+        m=2;
+      }
 
-        while ((p1[k+2]==0)&&(k!=p1[BCD_DEC]))
-        {
-          p1[BCD_LEN]-=1;
-          k--;
-        }
-        k_end=p1[BCD_LEN];
-        if (k_end>=(SCREEN_WIDTH-2))
-        {
-          k=0;
-          k_end=(SCREEN_WIDTH-2);
-          if (p1[BCD_SIGN]) k_end--;
-          if (p1[BCD_DEC]<k_end) k_end--;
-        }
-        else if (k_end==(SCREEN_WIDTH-3))
-        {
-          k=1;
-          if (p1[BCD_SIGN]) k=0;
-          if (p1[BCD_DEC]<k_end)
-          {
-            if (k==0) k_end--;
-            else k=0;
-          }
-        }
-        else
-        {
-          k=SCREEN_WIDTH-k_end-2;
-          if (p1[BCD_SIGN]) k--;
-          if (p1[BCD_DEC]<p1[BCD_LEN]) k--;
-        }
+      pos=m;
+      if (p1[BCD_SIGN]) text[pos++]='-';
+      for (k=0;k<k_end;k++)
+      {
+        text[pos++]=p1[k+l+3]+'0';
+        if (k==0) text[pos++]='.';
+      }
 
-        gotoxy(k+2,i);
-        if (p1[BCD_SIGN])
-        {
-          putchar('-');
-          k++;
-        }
-        for (l=3;l<k_end+3;l++)
-        {
-          //if (p1[BCD_DEC]==k-3) putchar('.');
-          //putchar(p1[k]+'0');
-          putchar(p1[l]+'0');
-          if (p1[BCD_DEC]==l-2)
-          {
-            if (l+k<(SCREEN_WIDTH)) putchar('.');
-          }
-        }
-        if (p1[BCD_DEC]>k_end)
-        {
-          gotoxy((SCREEN_WIDTH-1),i);
-          putchar('>');
-        }
+      text[pos++]='e';
+      k=p1[BCD_DEC]-l-1;
+      if (k<0)
+      {
+        text[pos++]='-';
+        k=-k;
+      }
+      m=0;
+      if (k/100) {text[pos++]='0'+(k/100);m=1;}
+      if (((k%100)/10)||m) {text[pos++]='0'+(k%100)/10;m=1;}
+      text[pos++]='0'+k%10;
+
+      //printf("Len: %d\n",x1[BCD_LEN]-i);
+      //printf("E: %d\n",x1[BCD_DEC]-i-1);
+    }
+  }
+  else
+  {
+    k=p1[BCD_LEN];
+
+    while ((p1[k+2]==0)&&(k!=p1[BCD_DEC]))
+    {
+      p1[BCD_LEN]-=1;
+      k--;
+    }
+    k_end=p1[BCD_LEN];
+    if (k_end>=(SCREEN_WIDTH-2))
+    {
+      k=0;
+      k_end=(SCREEN_WIDTH-2);
+      if (p1[BCD_SIGN]) k_end--;
+      if (p1[BCD_DEC]<k_end) k_end--;
+    }
+    else if (k_end==(SCREEN_WIDTH-3))
+    {
+      k=1;
+      if (p1[BCD_SIGN]) k=0;
+      if (p1[BCD_DEC]<k_end)
+      {
+        if (k==0) k_end--;
+        else k=0;
+      }
+    }
+    else
+    {
+      k=SCREEN_WIDTH-k_end-2;
+      if (p1[BCD_SIGN]) k--;
+      if (p1[BCD_DEC]<p1[BCD_LEN]) k--;
+    }
+
+    pos=k+2;
+    if (p1[BCD_SIGN])
+    {
+      text[pos++]='-';
+      k++;
+    }
+    for (l=3;l<k_end+3;l++)
+    {
+      //if (p1[BCD_DEC]==k-3) putchar('.');
+      //putchar(p1[k]+'0');
+      text[pos++]=p1[l]+'0';
+      if (p1[BCD_DEC]==l-2)
+      {
+        if (l+k<(SCREEN_WIDTH)) text[pos++]='.';
       }
     }
+    if (p1[BCD_DEC]>k_end) text[SCREEN_WIDTH-1]='>';
+  }
+}
+
+//Rows for level and up have to be formatted again
+static void DrawDirty(int level)
+{
+  int i;
+
+  for (i=0;i<SCREEN_ROWS;i++)
+  {
+    if (draw_cache[i].level>=level) draw_cache[i].level=-1;
   }
 }
 
+//Whole line goes to the shadow screen but LCD_Flush only sends what changed
+//so a digit typed at the end is one byte with the cursor already after it
 void DrawInput(unsigned char *line, int input_ptr, int offset, bool menu)
 {
   //#pragma MM_VAR line
@@ -4074,12 +6579,379 @@ void DrawInput(unsigned char *line, int input_ptr, int offset, bool menu)
   SetBlink(true);
 }
 
+//High precision worksheet. Up to HP_LEVELS numbers come off the stack, are
+//worked on at Settings.HpDigits and go back rounded to DecPlaces on escape
+static void HpSheet()
+{
+  struct HpHeadType head;
+  int key,i,count,offset=0,input_ptr=0;
+  bool redraw=true,typing=false,status=false,more=false;
+  unsigned char *x,*y;
+
+  hp_prec=Settings.HpLimbs;
+  count=stack_ptr[which_stack];
+  if (count>HP_LEVELS) count=HP_LEVELS;
+  stack_ptr[which_stack]-=count;
+  for (i=0;i<count;i++)
+  {
+    CopyBCD_EtI(ext_buff,BCD_stack+(stack_ptr[which_stack]+i)*MATH_CELL_SIZE);
+    HpFromBCD(HP_LEVEL(i),ext_buff);
+  }
+  hp_sp=count;
+  p0[0]=0;
+
+  do
+  {
+    if (redraw)
+    {
+      ClrLCD();
+      gotoxy(0,0);
+      if (status)
+      {
+        LCD_Text("Digits: ");
+        putchar('0'+Settings.HpDigits/100);
+        putchar('0'+(Settings.HpDigits/10)%10);
+        putchar('0'+Settings.HpDigits%10);
+        status=false;
+      }
+      else if (hp_sp>=2)
+      {
+        LCD_Text("Y:");
+        HpRound(HP_T(0),HP_LEVEL(hp_sp-2),Settings.HpDigits);
+        HpDraw(HP_T(0),0,SCREEN_WIDTH-2);
+      }
+      more=false;
+      if (hp_sp>=1)
+      {
+        HpRound(HP_T(0),HP_LEVEL(hp_sp-1),Settings.HpDigits);
+        gotoxy(0,1);
+        LCD_Text("X:");
+        more=HpDraw(HP_T(0),offset,SCREEN_WIDTH-2);
+        for (i=2;i<(typing?3:4);i++)
+        {
+          gotoxy(0,i);
+          more=HpDraw(HP_T(0),offset+i*SCREEN_WIDTH-SCREEN_WIDTH-2,SCREEN_WIDTH);
+        }
+      }
+      if (typing)
+      {
+        i=input_ptr-(SCREEN_WIDTH-1);
+        if (i<0) i=0;
+        DrawInput(p0,input_ptr,i,false);
+      }
+      redraw=false;
+    }
+
+    key=GetKey();
+    redraw=true;
+
+    if (((key>='0')&&(key<='9'))||(key=='.'))
+    {
+      if (input_ptr<(MATH_CELL_SIZE-1))
+      {
+        p0[input_ptr++]=key;
+        p0[input_ptr]=0;
+        typing=true;
+      }
+      continue;
+    }
+
+    if (typing)
+    {
+      if ((key==KEY_BACKSPACE)||(key==KEY_CLEAR))
+      {
+        if (key==KEY_CLEAR) input_ptr=0;
+        else input_ptr--;
+        p0[input_ptr]=0;
+        typing=(input_ptr!=0);
+        continue;
+      }
+      if (key==KEY_ESCAPE)
+      {
+        SetBlink(false);
+        input_ptr=0;
+        p0[0]=0;
+        typing=false;
+        key=0;
+        continue;
+      }
+
+      //anything else enters the number first like on the stack
+      count=0;
+      for (i=0;p0[i];i++) if (p0[i]=='.') count++;
+      if (count>1)
+      {
+        ErrorMsg("Invalid input");
+        continue;
+      }
+      SetBlink(false);
+      BufferBCD_ItI(p0,ext_buff);
+      HpFromBCD(HpPush(),ext_buff);
+      input_ptr=0;
+      p0[0]=0;
+      typing=false;
+      if (key==KEY_ENTER) key=0;
+    }
+
+    x=HP_LEVEL(hp_sp-1);
+    y=HP_LEVEL(hp_sp-2);
+    //an empty stack reads as zero so head is always set
+    if (hp_sp>=1) HpHead(&head,x);
+    else
+    {
+      head.sign=0;
+      head.len=0;
+      head.exp=0;
+    }
+    if ((key!=KEY_LEFT)&&(key!=KEY_RIGHT)) offset=0;
+    //results take a while at HP_DIGITS_MAX
+    gotoxy(SCREEN_WIDTH-1,0);
+    putchar('*');
+    LCD_Flush();
+
+    switch (key)
+    {
+      case '+':
+      case '-':
+        if (hp_sp>=2)
+        {
+          HpSum(y,y,x,key=='-');
+          hp_sp--;
+        }
+        break;
+      case '*':
+        if (hp_sp>=2)
+        {
+          HpMult(y,y,x);
+          hp_sp--;
+        }
+        break;
+      case '/':
+        if (hp_sp>=2)
+        {
+          if (head.len==0) ErrorMsg("Divide by zero");
+          else
+          {
+            HpDiv(y,y,x);
+            hp_sp--;
+          }
+        }
+        break;
+      case KEY_POW:
+        if (hp_sp>=2)
+        {
+          if (!HpLn(HP_T(17),y)) ErrorMsg("Invalid input");
+          else
+          {
+            HpMult(HP_T(17),HP_T(17),x);
+            if (HpExp(y,HP_T(17))) hp_sp--;
+            else ErrorMsg("Argument\ntoo large");
+          }
+        }
+        break;
+      case KEY_X2:
+        if (hp_sp>=1) HpMult(x,x,x);
+        break;
+      case KEY_1X:
+        if (hp_sp>=1)
+        {
+          if (head.len==0) ErrorMsg("Divide by zero");
+          else HpRecip(x,x);
+        }
+        break;
+      case KEY_SQRT:
+        if ((hp_sp>=1)&&(head.len))
+        {
+          if (head.sign) ErrorMsg("Invalid input");
+          else HpSqrt(x,x);
+        }
+        break;
+      case KEY_LN:
+        if (hp_sp>=1)
+        {
+          if (!HpLn(x,x)) ErrorMsg("Invalid input");
+        }
+        break;
+      case KEY_EX:
+        if (hp_sp>=1)
+        {
+          if (!HpExp(x,x)) ErrorMsg("Argument\ntoo large");
+        }
+        break;
+      case KEY_SIGN:
+        if ((hp_sp>=1)&&(head.len)) HpSetHead(x,!head.sign,head.len,head.exp);
+        break;
+      case KEY_SWAP:
+        if (hp_sp>=2)
+        {
+          HpCopy(HP_T(0),x);
+          HpCopy(x,y);
+          HpCopy(y,HP_T(0));
+        }
+        break;
+      case KEY_ENTER:
+      case KEY_DUPE:
+        if (hp_sp>=1)
+        {
+          x=HpPush();
+          HpCopy(x,HP_LEVEL(hp_sp-2));
+        }
+        break;
+      case KEY_BACKSPACE:
+      case KEY_DELETE:
+        if (hp_sp>=1) hp_sp--;
+        break;
+      case KEY_CLEAR:
+        hp_sp=0;
+        break;
+      case KEY_LEFT:
+        //scrolls X a line at a time
+        offset-=SCREEN_WIDTH;
+        if (offset<0) offset=0;
+        break;
+      case KEY_RIGHT:
+        if (more) offset+=SCREEN_WIDTH;
+        break;
+      case KEY_UP:
+      case KEY_DOWN:
+        if ((key==KEY_UP)&&(Settings.HpDigits<HP_DIGITS_MAX)) Settings.HpDigits+=100;
+        else if ((key==KEY_DOWN)&&(Settings.HpDigits>HP_DIGITS_MIN)) Settings.HpDigits-=100;
+        Settings.HpLimbs=Settings.HpDigits/LIMB_DIGITS+HP_GUARD_LIMBS;
+        hp_prec=Settings.HpLimbs;
+        status=true;
+        break;
+    }
+  } while (key!=KEY_ESCAPE);
+
+  SetBlink(false);
+  for (i=0;i<hp_sp;i++)
+  {
+    if (stack_ptr[which_stack]==STACK_SIZE)
+    {
+      ErrorMsg("Stack full");
+      break;
+    }
+    if (HpToBCD(ext_buff,HP_LEVEL(i),Settings.DecPlaces))
+    {
+      CommitBCD(BCD_stack+stack_ptr[which_stack]*MATH_CELL_SIZE,ext_buff);
+      stack_ptr[which_stack]++;
+    }
+    else ErrorMsg("Too large\nfor stack");
+  }
+  stack_version++;
+}
+
+//New level for X. The oldest is dropped when they're all full
+static unsigned char *HpPush()
+{
+  int i;
+
+  if (hp_sp==HP_LEVELS)
+  {
+    for (i=0;i<(HP_LEVELS-1);i++) HpCopy(HP_LEVEL(i),HP_LEVEL(i+1));
+    hp_sp--;
+  }
+  hp_sp++;
+  return HP_LEVEL(hp_sp-1);
+}
+
+//Prints up to width characters of cell written out in full starting offset
+//characters in. Digits are read a limb at a time as they're needed
+//True if there is more after
+static bool HpDraw(const unsigned char *cell, int offset, int width)
+{
+  struct HpHeadType head;
+  int i,j,k,lead=0,digits,point,pos,limb_ptr=-1;
+  unsigned int limb=0;
+  char c;
+
+  HpHead(&head,cell);
+  if (head.len==0)
+  {
+    if (offset==0) putchar('0');
+    return false;
+  }
+
+  //last non-zero limb then its trailing zeros
+  for (i=head.len;i>0;i-=HP_WINDOW)
+  {
+    j=i-HP_WINDOW;
+    if (j<0) j=0;
+    HpLoad(hp_wa,cell,head.len,j,i-j);
+    for (k=i-j-1;k>=0;k--) if (hp_wa[k]) break;
+    if (k>=0) break;
+  }
+  digits=LIMB_DIGITS*(j+k+1);
+  for (limb=hp_wa[k];(limb%10)==0;limb/=10) digits--;
+  HpLoad(hp_wa,cell,head.len,0,1);
+  for (k=1000;hp_wa[0]<k;k/=10) lead++;
+  digits-=lead;
+  point=LIMB_DIGITS*head.exp-lead;
+
+  for (pos=offset;pos<=offset+width;pos++)
+  {
+    //k is the digit at this position, -1 for a 0 before the digits
+    i=pos;
+    c=0;
+    if (head.sign)
+    {
+      if (i==0) c='-';
+      i--;
+    }
+    k=-2;
+    if (c==0)
+    {
+      if (point<=0)
+      {
+        if (i==0) c='0';
+        else if (i==1) c='.';
+        else if (i-2<-point) c='0';
+        else k=i-2+point;
+      }
+      else if (i<point) k=i;
+      else if (i==point)
+      {
+        if (digits>point) c='.';
+      }
+      else k=i-1;
+    }
+    if (k>=digits)
+    {
+      if (k<point) c='0';
+      k=-2;
+    }
+    if (k>=0)
+    {
+      j=(lead+k)/LIMB_DIGITS;
+      if (j!=limb_ptr)
+      {
+        HpLoad(hp_wa,cell,head.len,j,1);
+        limb=hp_wa[0];
+        limb_ptr=j;
+      }
+      for (j=(lead+k)%LIMB_DIGITS,i=limb;j<(LIMB_DIGITS-1);j++) i/=10;
+      c='0'+i%10;
+    }
+    if (c==0) return false;
+    if (pos==offset+width) break;
+    putchar(c);
+  }
+  return true;
+}
+
 static void ErrorMsg(const char *msg)
 {
   int i,j=0,tx,char_max=5,height=1;
 
   enum {CUST_NW,CUST_NE,CUST_WE,CUST_SW,CUST_S,CUST_OK_O,CUST_OK_K,CUST_E};
 
+  //nobody asked for this result
+  if (speculating)
+  {
+    spec_failed=true;
+    return;
+  }
+
   for (i=0;msg[i];i++)
   {
     if (msg[i]=='\n')